@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+// A shared_ptr that can be read and replaced concurrently - the publication
+// point for the managers' immutable data snapshots. Writers build a complete
+// new object and Store() it; readers Load() the current one and keep it
+// alive for as long as they use it, however many Store()s happen meanwhile.
+// Neither side ever waits on the other's work, only on the pointer swap
+// itself (which the standard library may guard with a short internal lock).
+//
+// Uses std::atomic<std::shared_ptr> where the standard library has it, and
+// the older atomic_load/atomic_store free functions elsewhere: libc++
+// (Android, Apple) does not implement the former, and libstdc++ 12's version
+// trips ThreadSanitizer, which the free functions (a hashed mutex pool
+// there) do not.
+template<typename T>
+class AtomicSharedPtr {
+public:
+  AtomicSharedPtr() = default;
+  explicit AtomicSharedPtr(std::shared_ptr<T> value) : m_value(std::move(value)) {}
+  AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+  AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+#if defined(__cpp_lib_atomic_shared_ptr) && !defined(__GLIBCXX__)
+  std::shared_ptr<T> Load() const { return m_value.load(std::memory_order_acquire); }
+  void Store(std::shared_ptr<T> value) { m_value.store(std::move(value), std::memory_order_release); }
+
+private:
+  std::atomic<std::shared_ptr<T>> m_value;
+#else
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+  std::shared_ptr<T> Load() const { return std::atomic_load_explicit(&m_value, std::memory_order_acquire); }
+  void Store(std::shared_ptr<T> value) {
+    std::atomic_store_explicit(&m_value, std::move(value), std::memory_order_release);
+  }
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+private:
+  std::shared_ptr<T> m_value;  // only accessed through atomic_load/atomic_store
+#endif
+};
@@ -1,5 +1,7 @@
 #include "ChannelManager.h"
 #include "Utils.h"
+#include "ModelFields.h"
+#include "JsonFieldTable.h"
 #include <kodi/General.h>
 
 // Standard library includes
@@ -8,19 +10,22 @@
 #include <map>
 #include <set>
 #include <functional>
-#include <mutex>
-#include <shared_mutex>
 #include <utility>
 #include <algorithm>
+#include <array>
 
 // nlohmann/json include
 #include <nlohmann/json.hpp>
 
 bool ChannelManager::LoadChannels(const std::vector<UltimateProvider>& providers,
-                                  const std::function<std::string(const std::string&)>& httpGet,
-                                  const std::function<bool(const std::string&, nlohmann::json&)>& parseJson) {
-  std::vector<UltimateChannel> newChannels;
-  std::map<int, ChannelLookupInfo> newLookup;
+                                  const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                                  const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                                  const FanOutExecutor& executor,
+                                  const LoadStatsSink& onStats) {
+  // Everything below works against this one view; channels published by a
+  // concurrent load meanwhile are not mixed in.
+  std::shared_ptr<const Data> held = m_data.Load();
+  const std::map<std::string, int>& loadedProviders = held->loadedProviders;
 
   // Use each provider's position in the (name-sorted, see ProviderManager)
   // providers vector as its channel-number offset index, rather than a
@@ -28,59 +33,211 @@ bool ChannelManager::LoadChannels(const std::vector<UltimateProvider>& providers
   // in the full list means disabling/enabling a provider does not shift the
   // channel numbers (and therefore clientChannelUid values used by existing
   // timers/recordings) of any other provider's channels.
-  for (size_t providerIndex = 0; providerIndex < providers.size(); ++providerIndex) {
+  //
+  // Providers load concurrently into per-provider slots that are merged in
+  // providers order below, so the result is identical to loading them one
+  // after another, whatever order the requests complete in.
+  struct ProviderChannels {
+    bool loaded = false;
+    std::vector<UltimateChannel> channels;
+  };
+  std::vector<ProviderChannels> perProvider(providers.size());
+
+  executor.Run(providers.size(), [&](size_t providerIndex) {
     const auto& provider = providers[providerIndex];
-    if (provider.enabled) {
-      LoadChannelsForProvider(provider.name, static_cast<int>(providerIndex),
-                              httpGet, parseJson, newChannels, newLookup);
+    if (!provider.enabled) return;
+
+    // Held channels are only reusable if they were numbered with the same
+    // offset - a provider added/removed before this one shifts it.
+    auto loaded = loadedProviders.find(provider.name);
+    bool conditional = loaded != loadedProviders.end() && loaded->second == static_cast<int>(providerIndex);
+
+    ProviderChannels& slot = perProvider[providerIndex];
+    auto start = LoadStats::Clock::now();
+    LoadStats stats;
+    stats.provider = provider.name;
+    slot.loaded = LoadChannelsForProvider(provider.name, static_cast<int>(providerIndex), conditional,
+                                          httpGet, parseJson, slot.channels, stats);
+    if (slot.loaded && stats.notModified) ReuseProviderChannels(*held, provider.name, slot.channels);
+    // A failed request keeps the channels held for the provider, so a
+    // background refresh during a backend hiccup does not empty Kodi's
+    // channel list. It stays "loaded" - the held channels still match the
+    // validators and offset of its last good response.
+    if (!slot.loaded && conditional) {
+      slot.channels.clear();
+      ReuseProviderChannels(*held, provider.name, slot.channels);
+      slot.loaded = true;
+    }
+    if (onStats) {
+      stats.ok = slot.loaded;
+      stats.wallMs = LoadStats::MsSince(start);
+      onStats(stats);
     }
+  });
+
+  auto data = std::make_shared<Data>();
+  std::vector<UltimateChannel> channels;
+  for (size_t providerIndex = 0; providerIndex < providers.size(); ++providerIndex) {
+    ProviderChannels& slot = perProvider[providerIndex];
+    if (!slot.loaded) continue;
+    channels.insert(channels.end(), std::make_move_iterator(slot.channels.begin()),
+                    std::make_move_iterator(slot.channels.end()));
+    data->loadedProviders[providers[providerIndex].name] = static_cast<int>(providerIndex);
   }
 
-  std::unique_lock<std::shared_mutex> lock(m_dataMutex);
-  m_channels = std::move(newChannels);
-  m_channelLookup = std::move(newLookup);
-  m_channelIndex.clear();
-  for (size_t i = 0; i < m_channels.size(); ++i) {
-    m_channelIndex[m_channels[i].channelNumber] = i;
+  Publish(std::move(data), channels);
+  return !channels.empty();
+}
+
+void ChannelManager::RestoreChannels(const std::vector<UltimateChannel>& channels) {
+  Publish(std::make_shared<Data>(), channels);
+}
+
+void ChannelManager::Publish(std::shared_ptr<Data> data, const std::vector<UltimateChannel>& channels) {
+  data->fingerprint = ModelFields::Fingerprint(channels, [](const UltimateChannel& channel, auto& v) {
+    ModelFields::VisitChannel(channel, v);
+  });
+  data->channels = ChannelStore(channels);
+  data->groups = BuildGroups(channels);
+  kodi::Log(ADDON_LOG_DEBUG, "Channels: %zu held in %zu bytes", data->channels.Size(), data->channels.MemoryUsage());
+  m_data.Store(std::move(data));
+}
+
+std::vector<ChannelManager::Group> ChannelManager::BuildGroups(const std::vector<UltimateChannel>& channels) {
+  // Indexed by isRadio. std::map keeps each kind's groups sorted by value.
+  std::vector<int> all[2];
+  std::map<std::string, std::vector<int>> byProvider[2], byCountry[2], byLanguage[2];
+  for (const auto& channel : channels) {
+    const int kind = channel.isRadio ? 1 : 0;
+    all[kind].push_back(channel.channelNumber);
+    byProvider[kind][channel.provider].push_back(channel.channelNumber);
+    if (!channel.country.empty()) byCountry[kind][channel.country].push_back(channel.channelNumber);
+    if (!channel.language.empty()) byLanguage[kind][channel.language].push_back(channel.channelNumber);
+  }
+
+  std::vector<Group> groups;
+  for (int kind = 0; kind < 2; ++kind) {
+    const bool isRadio = kind == 1;
+    // Same names as the two fixed groups this replaces, so Kodi keeps them.
+    groups.push_back({isRadio ? "Radio Stations" : "TV Channels", isRadio, all[kind]});
+    auto addGroups = [&](const char* prefix, std::map<std::string, std::vector<int>>& byValue) {
+      for (auto& [value, members] : byValue) {
+        if (members.size() == all[kind].size()) continue;
+        groups.push_back({prefix + value, isRadio, std::move(members)});
+      }
+    };
+    addGroups("Provider: ", byProvider[kind]);
+    addGroups("Country: ", byCountry[kind]);
+    addGroups("Language: ", byLanguage[kind]);
   }
+  return groups;
+}
 
-  return !m_channels.empty();
+uint64_t ChannelManager::GetFingerprint() const {
+  return m_data.Load()->fingerprint;
 }
 
-void ChannelManager::LoadChannelsForProvider(const std::string& provider, int providerIndex,
-                                             const std::function<std::string(const std::string&)>& httpGet,
+void ChannelManager::ReuseProviderChannels(const Data& held, const std::string& provider,
+                                           std::vector<UltimateChannel>& outChannels) {
+  for (size_t position = 0; position < held.channels.Size(); ++position) {
+    if (held.channels[position].Provider() == provider) outChannels.push_back(held.channels.ToChannel(position));
+  }
+}
+
+// Members of a channel entry that only feed derived UltimateChannel fields.
+struct DecodedChannel : UltimateChannel {
+  bool hasNumber = false;
+  int number = 0;  // "ChannelNumber", before the provider offset
+  bool hasChannelType = false;
+  bool channelTypeIsRadio = false;
+  bool hasIsRadio = false;
+};
+
+using ChannelField = JsonFieldTable::Fields<DecodedChannel>;
+static constexpr auto CHANNEL_FIELDS = JsonFieldTable::Sorted(std::array{
+  ChannelField::String<&UltimateChannel::channelName>("Name"),
+  ChannelField::String<&UltimateChannel::channelId>("Id"),
+  ChannelField::String<&UltimateChannel::iconPath>("LogoUrl"),
+  ChannelField::Custom("ChannelNumber", JsonFieldTable::Type::INTEGER,
+                       [](nlohmann::json& value, DecodedChannel& out) {
+                         out.hasNumber = true;
+                         out.number = value.get<int>();
+                       }),
+  ChannelField::String<&UltimateChannel::mode>("Mode"),
+  ChannelField::Boolean<&UltimateChannel::sessionManifest>("SessionManifest"),
+  ChannelField::String<&UltimateChannel::manifest>("Manifest"),
+  ChannelField::String<&UltimateChannel::manifestScript>("ManifestScript"),
+  ChannelField::Boolean<&UltimateChannel::useCdm>("UseCdm"),
+  ChannelField::String<&UltimateChannel::cdmMode>("CdmMode"),
+  ChannelField::String<&UltimateChannel::contentType>("ContentType"),
+  ChannelField::String<&UltimateChannel::country>("Country"),
+  ChannelField::String<&UltimateChannel::language>("Language"),
+  ChannelField::String<&UltimateChannel::streamingFormat>("StreamingFormat"),
+  ChannelField::Custom("ChannelType", JsonFieldTable::Type::STRING,
+                       [](nlohmann::json& value, DecodedChannel& out) {
+                         out.hasChannelType = true;
+                         out.channelTypeIsRadio = value.get_ref<const std::string&>() == "RADIO";
+                       }),
+  ChannelField::Custom("IsRadio", JsonFieldTable::Type::BOOLEAN,
+                       [](nlohmann::json& value, DecodedChannel& out) {
+                         out.hasIsRadio = true;
+                         out.isRadio = value.get<bool>();
+                       }),
+  ChannelField::Integer<&UltimateChannel::catchupHours>("CatchupHours"),
+});
+
+// Decodes one "channels" entry, moving its strings out of the document.
+static void DecodeChannel(nlohmann::json& channelJson, DecodedChannel& out) {
+  out.channelName = "Unknown";
+  out.mode = "live";
+  out.useCdm = true;
+  out.cdmMode = "external";
+  out.contentType = "LIVE";
+  out.language = "en";
+  JsonFieldTable::Decode(channelJson, CHANNEL_FIELDS, out);
+}
+
+bool ChannelManager::LoadChannelsForProvider(const std::string& provider, int providerIndex, bool conditional,
+                                             const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
                                              const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
                                              std::vector<UltimateChannel>& outChannels,
-                                             std::map<int, ChannelLookupInfo>& outLookup) {
+                                             LoadStats& stats) {
   std::string url = "/api/providers/" + Utils::UrlPathEncode(provider) + "/channels";
-  std::string response = httpGet(url);
+  std::string response = httpGet(url, conditional, stats.notModified);
+  if (stats.notModified) return true;
   if (response.empty()) {
     kodi::Log(ADDON_LOG_WARNING, "Empty response from %s", Utils::RedactUrl(url).c_str());
-    return;
+    return false;
   }
+  stats.bytes = response.size();
+  auto parseStart = LoadStats::Clock::now();
 
   nlohmann::json document;
   if (!parseJson(response, document)) {
     kodi::Log(ADDON_LOG_ERROR, "Failed to parse channels response from %s", provider.c_str());
-    return;
+    return false;
   }
   if (!document.contains("channels") || !document["channels"].is_array()) {
     kodi::Log(ADDON_LOG_ERROR, "Missing channels array in response from %s", provider.c_str());
-    return;
+    return false;
   }
 
-  // Store reference to avoid repeated map lookups / for readability
-  const auto& channelsArray = document["channels"];
+  auto& channelsArray = document["channels"];
+
+  // Decode every entry first: numbering needs the highest explicit channel
+  // number before fallback numbers can be handed out.
+  std::vector<DecodedChannel> decoded(channelsArray.size());
+  for (size_t i = 0; i < channelsArray.size(); ++i) {
+    DecodeChannel(channelsArray[i], decoded[i]);
+  }
 
   int providerOffset = providerIndex * PROVIDER_OFFSET_MULTIPLIER;
   int nextFallbackNumber = providerOffset + 1;
 
-  // First pass: find the maximum explicit channel number
   int maxExplicitNumber = providerOffset;
-  for (const auto& channelJson : channelsArray) {
-    if (channelJson.contains("ChannelNumber") && channelJson["ChannelNumber"].is_number_integer()) {
-      int num = channelJson["ChannelNumber"].get<int>() + providerOffset;
-      if (num > maxExplicitNumber) maxExplicitNumber = num;
+  for (const auto& entry : decoded) {
+    if (entry.hasNumber && entry.number + providerOffset > maxExplicitNumber) {
+      maxExplicitNumber = entry.number + providerOffset;
     }
   }
 
@@ -88,20 +245,13 @@ void ChannelManager::LoadChannelsForProvider(const std::string& provider, int pr
     nextFallbackNumber = maxExplicitNumber + 1;
   }
 
-  // Second pass: build channel objects
-  for (const auto& channelJson : channelsArray) {
-    UltimateChannel channel;
+  outChannels.reserve(outChannels.size() + decoded.size());
+  for (auto& entry : decoded) {
+    UltimateChannel& channel = entry;
     channel.provider = provider;
 
-    channel.channelName = (channelJson.contains("Name") && channelJson["Name"].is_string())
-                          ? channelJson["Name"].get<std::string>() : "Unknown";
-    channel.channelId = (channelJson.contains("Id") && channelJson["Id"].is_string())
-                        ? channelJson["Id"].get<std::string>() : "";
-    channel.iconPath = (channelJson.contains("LogoUrl") && channelJson["LogoUrl"].is_string())
-                       ? channelJson["LogoUrl"].get<std::string>() : "";
-
-    if (channelJson.contains("ChannelNumber") && channelJson["ChannelNumber"].is_number_integer()) {
-      channel.channelNumber = channelJson["ChannelNumber"].get<int>() + providerOffset;
+    if (entry.hasNumber) {
+      channel.channelNumber = entry.number + providerOffset;
       if (channel.channelNumber >= nextFallbackNumber) {
         nextFallbackNumber = channel.channelNumber + 1;
       }
@@ -110,87 +260,89 @@ void ChannelManager::LoadChannelsForProvider(const std::string& provider, int pr
     }
 
     channel.uniqueId = provider + ":" + channel.channelId;
-    channel.mode = (channelJson.contains("Mode") && channelJson["Mode"].is_string())
-                   ? channelJson["Mode"].get<std::string>() : "live";
-    channel.sessionManifest = (channelJson.contains("SessionManifest") && channelJson["SessionManifest"].is_boolean())
-                              ? channelJson["SessionManifest"].get<bool>() : false;
-    channel.manifest = (channelJson.contains("Manifest") && channelJson["Manifest"].is_string())
-                       ? channelJson["Manifest"].get<std::string>() : "";
-    channel.manifestScript = (channelJson.contains("ManifestScript") && channelJson["ManifestScript"].is_string())
-                             ? channelJson["ManifestScript"].get<std::string>() : "";
-    channel.useCdm = (channelJson.contains("UseCdm") && channelJson["UseCdm"].is_boolean())
-                     ? channelJson["UseCdm"].get<bool>() : true;
-    channel.cdmMode = (channelJson.contains("CdmMode") && channelJson["CdmMode"].is_string())
-                      ? channelJson["CdmMode"].get<std::string>() : "external";
-    channel.contentType = (channelJson.contains("ContentType") && channelJson["ContentType"].is_string())
-                          ? channelJson["ContentType"].get<std::string>() : "LIVE";
-    channel.country = (channelJson.contains("Country") && channelJson["Country"].is_string())
-                      ? channelJson["Country"].get<std::string>() : "";
-    channel.language = (channelJson.contains("Language") && channelJson["Language"].is_string())
-                       ? channelJson["Language"].get<std::string>() : "en";
-    channel.streamingFormat = (channelJson.contains("StreamingFormat") && channelJson["StreamingFormat"].is_string())
-                              ? channelJson["StreamingFormat"].get<std::string>() : "";
 
     // "ChannelType" is the field the backend actually sends for this purpose
     // (RecordingManager reads the same field from its own "channels" data).
     // IsRadio/contentType are kept as fallbacks in case a given provider
     // integration only populates one of the others.
-    if (channelJson.contains("ChannelType") && channelJson["ChannelType"].is_string()) {
-      channel.isRadio = (channelJson["ChannelType"].get<std::string>() == "RADIO");
-    } else if (channelJson.contains("IsRadio") && channelJson["IsRadio"].is_boolean()) {
-      channel.isRadio = channelJson["IsRadio"].get<bool>();
-    } else {
+    if (entry.hasChannelType) {
+      channel.isRadio = entry.channelTypeIsRadio;
+    } else if (!entry.hasIsRadio) {
       channel.isRadio = (channel.contentType == "RADIO");
     }
 
-    ChannelLookupInfo lookupInfo;
-    lookupInfo.provider = provider;
-    lookupInfo.channelId = channel.channelId;
-    lookupInfo.catchupHours = (channelJson.contains("CatchupHours") && channelJson["CatchupHours"].is_number_integer())
-                              ? channelJson["CatchupHours"].get<int>() : 0;
-
-    outLookup[channel.channelNumber] = lookupInfo;
-    outChannels.push_back(channel);
+    outChannels.push_back(std::move(channel));
   }
+  stats.items = decoded.size();
+  stats.parseMs = LoadStats::MsSince(parseStart);
+  return true;
 }
 
 int ChannelManager::GetChannelsAmount() const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  return static_cast<int>(m_channels.size());
+  return static_cast<int>(m_data.Load()->channels.Size());
 }
 
 bool ChannelManager::GetChannels(bool radio, kodi::addon::PVRChannelsResultSet& results) const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  for (const auto& channel : m_channels) {
-    if (channel.isRadio == radio) {
+  auto data = m_data.Load();
+  for (ChannelView channel : data->channels) {
+    if (channel.IsRadio() == radio) {
       kodi::addon::PVRChannel kodiChannel;
-      kodiChannel.SetUniqueId(channel.channelNumber);
-      kodiChannel.SetIsRadio(channel.isRadio);
-      kodiChannel.SetChannelNumber(channel.channelNumber);
-      kodiChannel.SetChannelName(channel.channelName);
-      kodiChannel.SetIconPath(channel.iconPath);
+      kodiChannel.SetUniqueId(channel.ChannelNumber());
+      kodiChannel.SetIsRadio(channel.IsRadio());
+      kodiChannel.SetChannelNumber(channel.ChannelNumber());
+      kodiChannel.SetChannelName(std::string(channel.ChannelName()));
+      kodiChannel.SetIconPath(std::string(channel.IconPath()));
       results.Add(kodiChannel);
     }
   }
   return true;
 }
 
-bool ChannelManager::GetChannelInfo(int channelUid, std::string& provider, std::string& channelId, int& catchupHours) const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  auto it = m_channelLookup.find(channelUid);
-  if (it == m_channelLookup.end()) return false;
-  provider = it->second.provider;
-  channelId = it->second.channelId;
-  catchupHours = it->second.catchupHours;
+int ChannelManager::GetChannelGroupsAmount() const {
+  return static_cast<int>(m_data.Load()->groups.size());
+}
+
+bool ChannelManager::GetChannelGroups(bool radio, kodi::addon::PVRChannelGroupsResultSet& results) const {
+  auto data = m_data.Load();
+  unsigned int position = 0;
+  for (const auto& group : data->groups) {
+    if (group.isRadio != radio) continue;
+    kodi::addon::PVRChannelGroup kodiGroup;
+    kodiGroup.SetIsRadio(group.isRadio);
+    kodiGroup.SetGroupName(group.name);
+    kodiGroup.SetPosition(++position);
+    results.Add(kodiGroup);
+  }
   return true;
 }
 
-bool ChannelManager::GetChannelByUid(int channelUid, UltimateChannel& channel) const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  auto it = m_channelIndex.find(channelUid);
-  if (it != m_channelIndex.end() && it->second < m_channels.size()) {
-    channel = m_channels[it->second];
+bool ChannelManager::GetChannelGroupMembers(const std::string& groupName, bool radio,
+                                            kodi::addon::PVRChannelGroupMembersResultSet& results) const {
+  auto data = m_data.Load();
+  for (const auto& group : data->groups) {
+    if (group.isRadio != radio || group.name != groupName) continue;
+    for (int channelUid : group.members) {
+      kodi::addon::PVRChannelGroupMember member;
+      member.SetGroupName(group.name);
+      member.SetChannelUniqueId(channelUid);
+      member.SetChannelNumber(channelUid);
+      results.Add(member);
+    }
     return true;
   }
   return false;
+}
+
+bool ChannelManager::GetChannelInfo(int channelUid, std::string& provider, std::string& channelId, int& catchupHours) const {
+  auto data = m_data.Load();
+  ChannelView channel;
+  if (!data->channels.Find(channelUid, channel)) return false;
+  provider = channel.Provider();
+  channelId = channel.ChannelId();
+  catchupHours = channel.CatchupHours();
+  return true;
+}
+
+bool ChannelManager::FindChannel(const Data& data, int channelUid, ChannelView& channel) {
+  return data.channels.Find(channelUid, channel);
 }
\ No newline at end of file
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "Models.h"
+#include "FanOutExecutor.h"
+#include "LoadStats.h"
+#include "AtomicSharedPtr.h"
+#include "ChannelStore.h"
 #include <kodi/addon-instance/PVR.h>
 #include <vector>
 #include <map>
-#include <unordered_map>
-#include <shared_mutex>
+#include <memory>
 #include <functional>
 #include <string>
 #include <nlohmann/json.hpp>
@@ -14,34 +17,82 @@ class ChannelManager {
 public:
     static constexpr int PROVIDER_OFFSET_MULTIPLIER = 100000;
 
+    // A channel group as Kodi lists it, derived from channel metadata when
+    // the channels are published.
+    struct Group {
+        std::string name;
+        bool isRadio = false;
+        std::vector<int> members;  // channel UIDs, in channel order
+    };
+
+    // Immutable view of the held channels, published whole by every load or
+    // restore. A reader keeps a consistent channel list and UID index for as
+    // long as it holds the pointer, without locking.
+    struct Data {
+        ChannelStore channels;
+        std::vector<Group> groups;  // in listing order, see BuildGroups
+        // Providers whose channels came from a usable response, with the
+        // providerIndex (channel-number offset) they were numbered with.
+        std::map<std::string, int> loadedProviders;
+        uint64_t fingerprint = 0;
+    };
+
     ChannelManager() = default;
 
+    // httpGet has the conditional-GET contract described at
+    // ProviderManager::LoadProviders; a provider whose channel list is not
+    // modified keeps its current channels. Providers are fetched in parallel
+    // on executor; httpGet and parseJson must be safe to call concurrently.
+    // onStats, if set, receives each enabled provider's LoadStats.
     bool LoadChannels(const std::vector<UltimateProvider>& providers,
-                      const std::function<std::string(const std::string&)>& httpGet,
-                      const std::function<bool(const std::string&, nlohmann::json&)>& parseJson);
+                      const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                      const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                      const FanOutExecutor& executor,
+                      const LoadStatsSink& onStats = nullptr);
+
+    // Serves channels from a warm-start snapshot; like a failed load, no
+    // provider counts as loaded, so the next LoadChannels fetches all of them.
+    void RestoreChannels(const std::vector<UltimateChannel>& channels);
+
+    // Content fingerprint of the held channels (ModelFields::Fingerprint), for
+    // telling whether a load changed anything Kodi would see.
+    uint64_t GetFingerprint() const;
 
     int GetChannelsAmount() const;
     bool GetChannels(bool radio, kodi::addon::PVRChannelsResultSet& results) const;
+    int GetChannelGroupsAmount() const;
+    bool GetChannelGroups(bool radio, kodi::addon::PVRChannelGroupsResultSet& results) const;
+    bool GetChannelGroupMembers(const std::string& groupName, bool radio,
+                                kodi::addon::PVRChannelGroupMembersResultSet& results) const;
     bool GetChannelInfo(int channelUid, std::string& provider, std::string& channelId, int& catchupHours) const;
-    bool GetChannelByUid(int channelUid, UltimateChannel& channel) const;
 
-    const std::vector<UltimateChannel>& GetChannels() const { return m_channels; }
-    const std::map<int, ChannelLookupInfo>& GetLookup() const { return m_channelLookup; }
+    std::shared_ptr<const Data> GetData() const { return m_data.Load(); }
 
-    void LockShared() const { m_dataMutex.lock_shared(); }
-    void UnlockShared() const { m_dataMutex.unlock_shared(); }
-    void LockUnique() const { m_dataMutex.lock(); }
-    void UnlockUnique() const { m_dataMutex.unlock(); }
+    // Looks a channel up by its UID (channel number) without copying it;
+    // channel is only valid while data is held.
+    static bool FindChannel(const Data& data, int channelUid, ChannelView& channel);
 
 private:
-    static void LoadChannelsForProvider(const std::string& provider, int providerIndex,
-                                        const std::function<std::string(const std::string&)>& httpGet,
+    // Returns true if the provider's channel list was loaded (or, with
+    // stats.notModified set, is unchanged and nothing was added to the outputs).
+    static bool LoadChannelsForProvider(const std::string& provider, int providerIndex, bool conditional,
+                                        const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
                                         const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
                                         std::vector<UltimateChannel>& outChannels,
-                                        std::map<int, ChannelLookupInfo>& outLookup);
+                                        LoadStats& stats);
+
+    // Copies a provider's channels in held into outChannels.
+    static void ReuseProviderChannels(const Data& held, const std::string& provider,
+                                      std::vector<UltimateChannel>& outChannels);
+
+    // All TV and all radio channels, then per provider, per country and per
+    // language, each split by TV/radio. A metadata group that would hold
+    // every channel of its kind duplicates the "all" group and is left out.
+    static std::vector<Group> BuildGroups(const std::vector<UltimateChannel>& channels);
+
+    // Stores channels into data along with their groups and fingerprint, then
+    // publishes it.
+    void Publish(std::shared_ptr<Data> data, const std::vector<UltimateChannel>& channels);
 
-    std::vector<UltimateChannel> m_channels;
-    std::map<int, ChannelLookupInfo> m_channelLookup;
-    std::unordered_map<int, size_t> m_channelIndex;  // channelNumber -> index into m_channels, O(1) GetChannelByUid
-    mutable std::shared_mutex m_dataMutex;
+    AtomicSharedPtr<const Data> m_data{std::make_shared<const Data>()};
 };
\ No newline at end of file
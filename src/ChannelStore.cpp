@@ -0,0 +1,140 @@
+#include "ChannelStore.h"
+#include <unordered_map>
+
+int ChannelView::ChannelNumber() const { return m_store->m_records[m_position].channelNumber; }
+int ChannelView::CatchupHours() const { return m_store->m_records[m_position].catchupHours; }
+bool ChannelView::IsRadio() const { return m_store->m_records[m_position].isRadio; }
+bool ChannelView::SessionManifest() const { return m_store->m_records[m_position].sessionManifest; }
+bool ChannelView::UseCdm() const { return m_store->m_records[m_position].useCdm; }
+
+std::string_view ChannelView::UniqueId() const { return m_store->Get(m_store->m_records[m_position].uniqueId); }
+std::string_view ChannelView::ChannelName() const { return m_store->Get(m_store->m_records[m_position].channelName); }
+std::string_view ChannelView::IconPath() const { return m_store->Get(m_store->m_records[m_position].iconPath); }
+std::string_view ChannelView::Provider() const { return m_store->Get(m_store->m_records[m_position].provider); }
+std::string_view ChannelView::ChannelId() const { return m_store->Get(m_store->m_records[m_position].channelId); }
+std::string_view ChannelView::Mode() const { return m_store->Get(m_store->m_records[m_position].mode); }
+std::string_view ChannelView::Manifest() const { return m_store->Get(m_store->m_records[m_position].manifest); }
+std::string_view ChannelView::ManifestScript() const {
+  return m_store->Get(m_store->m_records[m_position].manifestScript);
+}
+std::string_view ChannelView::CdmMode() const { return m_store->Get(m_store->m_records[m_position].cdmMode); }
+std::string_view ChannelView::ContentType() const { return m_store->Get(m_store->m_records[m_position].contentType); }
+std::string_view ChannelView::Country() const { return m_store->Get(m_store->m_records[m_position].country); }
+std::string_view ChannelView::Language() const { return m_store->Get(m_store->m_records[m_position].language); }
+std::string_view ChannelView::StreamingFormat() const {
+  return m_store->Get(m_store->m_records[m_position].streamingFormat);
+}
+
+ChannelStore::ChannelStore(const std::vector<UltimateChannel>& channels) {
+  size_t poolSize = 0;
+  for (const auto& channel : channels) {
+    poolSize += channel.uniqueId.size() + channel.channelName.size() + channel.iconPath.size() +
+                channel.channelId.size() + channel.manifest.size() + channel.manifestScript.size();
+  }
+  m_pool.reserve(poolSize);
+
+  // Strings that are (nearly) unique per channel are appended as they are;
+  // the others go through the interning table, so each distinct value is in
+  // the pool once. Keys point into channels, which outlive the build - the
+  // pool may reallocate while it grows, so it is only addressed by offset.
+  auto append = [this](const std::string& value) {
+    Text text{static_cast<uint32_t>(m_pool.size()), static_cast<uint32_t>(value.size())};
+    m_pool += value;
+    return text;
+  };
+  std::unordered_map<std::string_view, Text> interned;
+  auto intern = [&](const std::string& value) {
+    if (value.empty()) return Text{};
+    auto [it, inserted] = interned.try_emplace(value);
+    if (inserted) it->second = append(value);
+    return it->second;
+  };
+
+  m_records.reserve(channels.size());
+  for (const auto& channel : channels) {
+    Record& record = m_records.emplace_back();
+    record.channelNumber = channel.channelNumber;
+    record.catchupHours = channel.catchupHours;
+    record.isRadio = channel.isRadio;
+    record.sessionManifest = channel.sessionManifest;
+    record.useCdm = channel.useCdm;
+    record.uniqueId = append(channel.uniqueId);
+    record.channelName = append(channel.channelName);
+    record.iconPath = append(channel.iconPath);
+    record.provider = intern(channel.provider);
+    record.channelId = append(channel.channelId);
+    record.mode = intern(channel.mode);
+    record.manifest = append(channel.manifest);
+    record.manifestScript = append(channel.manifestScript);
+    record.cdmMode = intern(channel.cdmMode);
+    record.contentType = intern(channel.contentType);
+    record.country = intern(channel.country);
+    record.language = intern(channel.language);
+    record.streamingFormat = intern(channel.streamingFormat);
+  }
+  m_pool.shrink_to_fit();
+  BuildIndex();
+}
+
+void ChannelStore::BuildIndex() {
+  if (m_records.empty()) return;
+  int bits = 1;
+  while ((size_t{1} << bits) < m_records.size() * 2) ++bits;
+  m_slots.assign(size_t{1} << bits, Slot{});
+  m_slotShift = 32 - bits;
+
+  const size_t mask = m_slots.size() - 1;
+  for (size_t position = 0; position < m_records.size(); ++position) {
+    const int uid = m_records[position].channelNumber;
+    size_t slot = SlotOf(uid);
+    while (m_slots[slot].position != EMPTY_SLOT && m_slots[slot].uid != uid) slot = (slot + 1) & mask;
+    m_slots[slot] = Slot{uid, static_cast<uint32_t>(position)};
+  }
+}
+
+bool ChannelStore::Find(int channelUid, ChannelView& channel) const {
+  if (m_slots.empty()) return false;
+  const size_t mask = m_slots.size() - 1;
+  for (size_t slot = SlotOf(channelUid); m_slots[slot].position != EMPTY_SLOT; slot = (slot + 1) & mask) {
+    if (m_slots[slot].uid == channelUid) {
+      channel = ChannelView(this, m_slots[slot].position);
+      return true;
+    }
+  }
+  return false;
+}
+
+UltimateChannel ChannelStore::ToChannel(size_t position) const {
+  const Record& record = m_records[position];
+  UltimateChannel channel;
+  channel.uniqueId = Get(record.uniqueId);
+  channel.channelNumber = record.channelNumber;
+  channel.catchupHours = record.catchupHours;
+  channel.channelName = Get(record.channelName);
+  channel.iconPath = Get(record.iconPath);
+  channel.provider = Get(record.provider);
+  channel.channelId = Get(record.channelId);
+  channel.isRadio = record.isRadio;
+  channel.mode = Get(record.mode);
+  channel.sessionManifest = record.sessionManifest;
+  channel.manifest = Get(record.manifest);
+  channel.manifestScript = Get(record.manifestScript);
+  channel.useCdm = record.useCdm;
+  channel.cdmMode = Get(record.cdmMode);
+  channel.contentType = Get(record.contentType);
+  channel.country = Get(record.country);
+  channel.language = Get(record.language);
+  channel.streamingFormat = Get(record.streamingFormat);
+  return channel;
+}
+
+std::vector<UltimateChannel> ChannelStore::ToChannels() const {
+  std::vector<UltimateChannel> channels;
+  channels.reserve(m_records.size());
+  for (size_t position = 0; position < m_records.size(); ++position) channels.push_back(ToChannel(position));
+  return channels;
+}
+
+size_t ChannelStore::MemoryUsage() const {
+  return m_records.capacity() * sizeof(Record) + m_pool.capacity() + m_slots.capacity() * sizeof(Slot);
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Models.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ChannelStore;
+
+// Read-only view of one channel in a ChannelStore. Cheap to copy, allocation
+// free, and only valid while the store it came from is alive - in practice,
+// while the caller holds the ChannelManager::Data snapshot.
+class ChannelView {
+public:
+  ChannelView() = default;
+
+  int ChannelNumber() const;
+  int CatchupHours() const;
+  bool IsRadio() const;
+  bool SessionManifest() const;
+  bool UseCdm() const;
+
+  std::string_view UniqueId() const;
+  std::string_view ChannelName() const;
+  std::string_view IconPath() const;
+  std::string_view Provider() const;
+  std::string_view ChannelId() const;
+  std::string_view Mode() const;
+  std::string_view Manifest() const;
+  std::string_view ManifestScript() const;
+  std::string_view CdmMode() const;
+  std::string_view ContentType() const;
+  std::string_view Country() const;
+  std::string_view Language() const;
+  std::string_view StreamingFormat() const;
+
+private:
+  friend class ChannelStore;
+  ChannelView(const ChannelStore* store, size_t position) : m_store(store), m_position(position) {}
+
+  const ChannelStore* m_store = nullptr;
+  size_t m_position = 0;
+};
+
+// Immutable, compact form of a channel list. All strings live in one
+// character pool, values repeated across thousands of channels (provider,
+// country, language, CDM mode, content type, ...) interned so each is stored
+// once, and each channel is a fixed-size record of pool offsets instead of a
+// dozen std::strings with their own heap blocks. UltimateChannel stays the
+// decode, snapshot and fingerprint model; ToChannel() converts back.
+//
+// The store is also the one index by channel UID (channel number): an
+// open-addressing table of (uid, position) slots, at most half full, so a
+// lookup is a multiply, a shift and usually a single probe into one
+// contiguous array.
+class ChannelStore {
+public:
+  ChannelStore() = default;
+  explicit ChannelStore(const std::vector<UltimateChannel>& channels);
+
+  size_t Size() const { return m_records.size(); }
+  bool Empty() const { return m_records.empty(); }
+  ChannelView operator[](size_t position) const { return ChannelView(this, position); }
+
+  // If two channels share a UID, the later one is found.
+  bool Find(int channelUid, ChannelView& channel) const;
+
+  UltimateChannel ToChannel(size_t position) const;
+  std::vector<UltimateChannel> ToChannels() const;
+
+  // Heap bytes held: records, string pool and UID index.
+  size_t MemoryUsage() const;
+
+  class Iterator {
+  public:
+    Iterator(const ChannelStore* store, size_t position) : m_store(store), m_position(position) {}
+    ChannelView operator*() const { return (*m_store)[m_position]; }
+    Iterator& operator++() { ++m_position; return *this; }
+    bool operator!=(const Iterator& other) const { return m_position != other.m_position; }
+
+  private:
+    const ChannelStore* m_store;
+    size_t m_position;
+  };
+  Iterator begin() const { return Iterator(this, 0); }
+  Iterator end() const { return Iterator(this, m_records.size()); }
+
+private:
+  friend class ChannelView;
+
+  // A string in m_pool.
+  struct Text {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+  };
+
+  struct Record {
+    int channelNumber = 0;
+    int catchupHours = 0;
+    bool isRadio = false;
+    bool sessionManifest = false;
+    bool useCdm = true;
+    Text uniqueId;
+    Text channelName;
+    Text iconPath;
+    Text provider;
+    Text channelId;
+    Text mode;
+    Text manifest;
+    Text manifestScript;
+    Text cdmMode;
+    Text contentType;
+    Text country;
+    Text language;
+    Text streamingFormat;
+  };
+
+  std::string_view Get(Text text) const { return std::string_view(m_pool.data() + text.offset, text.length); }
+
+  static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+  struct Slot {
+    int uid = 0;
+    uint32_t position = EMPTY_SLOT;
+  };
+
+  // Fibonacci hashing: the top bits of uid * 2^32/phi pick the slot.
+  size_t SlotOf(int channelUid) const {
+    return (static_cast<uint32_t>(channelUid) * 2654435769u) >> m_slotShift;
+  }
+  void BuildIndex();
+
+  std::vector<Record> m_records;
+  std::string m_pool;
+  std::vector<Slot> m_slots;  // power-of-two size, empty for an empty store
+  int m_slotShift = 32;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "Utils.h"
+
+// Delta sync for the per-provider recording and timer lists.
+//
+// A provider whose list response carried a "cursor" is asked for changes
+// only on the next load: "?since=<cursor>" is added to its list URL and a
+// backend that supports it answers with "delta": true, the added/changed
+// entries in the usual list array, the keys of deleted entries in "removed"
+// and a new "cursor". Any other answer (no "delta" flag, e.g. a backend that
+// ignores the parameter or has expired the cursor) is a full list and
+// replaces what is held, so a backend without cursor support just keeps
+// getting full (conditional) reloads.
+class DeltaSync {
+public:
+  // url unchanged when there is no cursor (full load).
+  static std::string AppendSince(const std::string& url, const std::string& cursor) {
+    if (cursor.empty()) return url;
+    return url + (url.find('?') == std::string::npos ? "?" : "&") + "since=" + Utils::UrlEncode(cursor);
+  }
+
+  // Applies a delta to the entries currently held for one provider: entries in
+  // changed replace the held entry with the same key or are appended, entries
+  // whose key is in removed are dropped. Held order is otherwise kept.
+  template <class T, class Key, class KeyOf>
+  static void Apply(std::vector<T>& held, std::vector<T>&& changed, const std::vector<Key>& removed, KeyOf keyOf) {
+    std::unordered_map<Key, size_t> index;
+    index.reserve(held.size());
+    for (size_t i = 0; i < held.size(); ++i) index[keyOf(held[i])] = i;
+
+    for (auto& entry : changed) {
+      auto it = index.find(keyOf(entry));
+      if (it != index.end()) {
+        held[it->second] = std::move(entry);
+      } else {
+        index[keyOf(entry)] = held.size();
+        held.push_back(std::move(entry));
+      }
+    }
+
+    if (removed.empty()) return;
+    std::unordered_set<Key> removedKeys(removed.begin(), removed.end());
+    std::erase_if(held, [&](const T& entry) { return removedKeys.contains(keyOf(entry)); });
+  }
+};
@@ -0,0 +1,125 @@
+#include "EPGCache.h"
+#include <algorithm>
+
+std::vector<std::pair<time_t, time_t>> EPGCache::Missing(int channelUid, time_t start, time_t end) {
+  std::vector<std::pair<time_t, time_t>> missing = Gaps(channelUid, start, end);
+  if (end <= start) return missing;
+  if (missing.empty()) m_hits++;
+  else m_misses++;
+  return missing;
+}
+
+std::vector<std::pair<time_t, time_t>> EPGCache::Gaps(int channelUid, time_t start, time_t end) {
+  std::vector<std::pair<time_t, time_t>> missing;
+  if (end <= start) return missing;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_channels.find(channelUid);
+  if (!IsEnabled() || it == m_channels.end()) {
+    missing.emplace_back(start, end);
+  } else {
+    Prune(it->second, Clock::now());
+    time_t covered = start;
+    for (const Range& range : it->second.ranges) {
+      if (range.end <= covered) continue;
+      if (range.start >= end) break;
+      if (range.start > covered) missing.emplace_back(covered, range.start);
+      covered = range.end;
+      if (covered >= end) break;
+    }
+    if (covered < end) missing.emplace_back(covered, end);
+  }
+  return missing;
+}
+
+void EPGCache::Collect(int channelUid, time_t start, time_t end, std::vector<EPGEvent>& events) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_channels.find(channelUid);
+  if (it == m_channels.end()) return;
+  Channel& channel = it->second;
+  Prune(channel, Clock::now());
+
+  const uint64_t queryStart = static_cast<uint64_t>(start);
+  const uint64_t queryEnd = static_cast<uint64_t>(end);
+  const uint64_t from = queryStart > channel.maxDuration ? queryStart - channel.maxDuration : 0;
+  auto event = std::lower_bound(channel.events.begin(), channel.events.end(), from,
+                                [](const EPGEvent& e, uint64_t value) { return e.start < value; });
+  for (; event != channel.events.end() && event->start < queryEnd; ++event) {
+    if (event->end > queryStart) events.push_back(*event);
+  }
+}
+
+void EPGCache::Put(int channelUid, time_t start, time_t end, const std::vector<EPGEvent>& events,
+                   std::chrono::seconds age) {
+  if (!IsEnabled() || end <= start) return;
+  const Clock::time_point now = Clock::now();
+  const Clock::time_point expires = now + std::chrono::seconds(m_ttlSeconds.load()) - age;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Channel& channel = m_channels[channelUid];
+  Prune(channel, now);
+
+  // The new range replaces the parts of older ones it overlaps; what is
+  // left of those keeps its own expiry.
+  std::vector<Range> ranges;
+  for (const Range& range : channel.ranges) {
+    if (range.end <= start || range.start >= end) {
+      ranges.push_back(range);
+      continue;
+    }
+    if (range.start < start) ranges.push_back({range.start, start, range.expires});
+    if (range.end > end) ranges.push_back({end, range.end, range.expires});
+  }
+  ranges.push_back({start, end, expires});
+  std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return a.start < b.start; });
+  channel.ranges = std::move(ranges);
+
+  // New events first, so when an event straddling the window edge was held
+  // from a neighbouring fetch and is sent again, the stable sort puts the
+  // fresh copy first and unique() keeps it.
+  const uint64_t windowStart = static_cast<uint64_t>(start);
+  const uint64_t windowEnd = static_cast<uint64_t>(end);
+  std::vector<EPGEvent> merged = events;
+  for (auto& held : channel.events) {
+    if (held.start < windowStart || held.start >= windowEnd) merged.push_back(std::move(held));
+  }
+  std::stable_sort(merged.begin(), merged.end(),
+                   [](const EPGEvent& a, const EPGEvent& b) { return a.start < b.start; });
+  merged.erase(std::unique(merged.begin(), merged.end(),
+                           [](const EPGEvent& a, const EPGEvent& b) {
+                             return a.start == b.start && a.end == b.end && a.title == b.title;
+                           }),
+               merged.end());
+  channel.events = std::move(merged);
+
+  channel.maxDuration = 0;
+  for (const auto& event : channel.events) {
+    if (event.end > event.start) channel.maxDuration = std::max(channel.maxDuration, event.end - event.start);
+  }
+}
+
+void EPGCache::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_channels.clear();
+}
+
+void EPGCache::Prune(Channel& channel, Clock::time_point now) {
+  auto expired = std::remove_if(channel.ranges.begin(), channel.ranges.end(),
+                                [now](const Range& range) { return range.expires <= now; });
+  if (expired == channel.ranges.end()) return;
+  channel.ranges.erase(expired, channel.ranges.end());
+
+  // Ranges are sorted and disjoint, so their ends are sorted too: the first
+  // range ending after an event's start is the only one it can overlap.
+  const auto& ranges = channel.ranges;
+  channel.events.erase(
+      std::remove_if(channel.events.begin(), channel.events.end(),
+                     [&ranges](const EPGEvent& event) {
+                       auto range = std::upper_bound(ranges.begin(), ranges.end(), event.start,
+                                                     [](uint64_t value, const Range& r) {
+                                                       return value < static_cast<uint64_t>(r.end);
+                                                     });
+                       return range == ranges.end() || static_cast<uint64_t>(range->start) >= event.end;
+                     }),
+      channel.events.end());
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Models.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// In-memory EPG cache keyed by channel UID. Per channel it holds the events
+// sorted by start time and the time ranges that were actually fetched, each
+// with its own expiry. Missing() tells a caller which parts of a window live
+// ranges do not cover; it fetches just those and Put()s them, each replacing
+// whatever was held for its range, and then Collect()s the whole window.
+//
+// Expiry runs on the steady clock, which does not advance while the system
+// sleeps - callers Clear() on wake.
+class EPGCache {
+public:
+  EPGCache() = default;
+
+  // 0 disables the cache: nothing is covered and Put() stores nothing.
+  void SetTtl(std::chrono::seconds ttl) { m_ttlSeconds = ttl.count(); }
+  std::chrono::seconds GetTtl() const { return std::chrono::seconds(m_ttlSeconds.load()); }
+  bool IsEnabled() const { return m_ttlSeconds.load() > 0; }
+
+  // The parts of [start, end) no live range covers, in order. Counts a hit
+  // when there are none, a miss otherwise.
+  std::vector<std::pair<time_t, time_t>> Missing(int channelUid, time_t start, time_t end);
+  // Missing() without counting, for rechecks and prefetching.
+  std::vector<std::pair<time_t, time_t>> Gaps(int channelUid, time_t start, time_t end);
+
+  // Appends the held events overlapping [start, end) to events, in start order.
+  void Collect(int channelUid, time_t start, time_t end, std::vector<EPGEvent>& events);
+
+  // Stores the response for [start, end). Held events starting inside the
+  // window are dropped first, so events the backend removed do not linger.
+  // age is how old the data already is (a stored day); it expires that much
+  // sooner.
+  void Put(int channelUid, time_t start, time_t end, const std::vector<EPGEvent>& events,
+           std::chrono::seconds age = std::chrono::seconds(0));
+
+  void Clear();
+
+  uint64_t GetHitCount() const { return m_hits.load(); }
+  uint64_t GetMissCount() const { return m_misses.load(); }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Range {
+    time_t start;
+    time_t end;
+    Clock::time_point expires;
+  };
+
+  struct Channel {
+    std::vector<Range> ranges;    // sorted by start, non-overlapping
+    std::vector<EPGEvent> events;  // sorted by start
+    // Longest event held, so an overlap query only has to look this far
+    // back before its start.
+    uint64_t maxDuration = 0;
+  };
+
+  // Drops expired ranges and the events no live range overlaps any more.
+  static void Prune(Channel& channel, Clock::time_point now);
+
+  std::atomic<int64_t> m_ttlSeconds{0};
+  std::mutex m_mutex;
+  std::unordered_map<int, Channel> m_channels;
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+};
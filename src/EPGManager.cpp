@@ -1,99 +1,100 @@
 #include "EPGManager.h"
 #include "Utils.h"
+#include "EPGSaxHandler.h"
 #include <kodi/General.h>
 #include <sstream>
 #include <ctime>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <tuple>
 #include <vector>
 
-// Shared parsing logic - single source of truth for EPG JSON -> PVREPGTag mapping.
-bool EPGManager::ParseEPGResponse(const std::string& response,
-                                   int channelUid,
-                                   const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                   kodi::addon::PVREPGTagsResultSet& results) {
-  nlohmann::json document;
-  if (!parseJson(response, document)) return false;
+static_assert(EPGManager::FETCH_BUCKET_SECONDS == EPGStore::DAY_SECONDS,
+              "fetch buckets must be the EPG store's days, so whole fetched buckets can be stored");
 
+// DOM extraction - single source of truth for the EPG JSON field mapping
+// (EPGSaxHandler mirrors it for the streaming path).
+bool EPGManager::ExtractEvents(const nlohmann::json& document, std::vector<EPGEvent>& events) {
   if (!document.contains("epg") || !document["epg"].is_array()) return false;
 
-  struct ParsedTag {
-    kodi::addon::PVREPGTag tag;
-    uint64_t start;
-    uint64_t end;
-    std::string title;
-  };
-  std::vector<ParsedTag> parsedTags;
-
   for (const auto& epgItem : document["epg"]) {
     if (!epgItem.is_object()) continue;
 
-    uint64_t eStart = (epgItem.contains("start") && epgItem["start"].is_number_integer()) ? epgItem["start"].get<uint64_t>() : 0;
-    uint64_t eEnd = (epgItem.contains("end") && epgItem["end"].is_number_integer()) ? epgItem["end"].get<uint64_t>() : 0;
+    EPGEvent event;
+    event.start = (epgItem.contains("start") && epgItem["start"].is_number_integer()) ? epgItem["start"].get<uint64_t>() : 0;
+    event.end = (epgItem.contains("end") && epgItem["end"].is_number_integer()) ? epgItem["end"].get<uint64_t>() : 0;
 
     // Backend occasionally sends malformed entries with zero or inverted timestamps
     // (observed in live responses) - these are unusable for Kodi's EPG grid, skip them.
-    if (eStart == 0 || eEnd == 0 || eEnd <= eStart) continue;
-
-    kodi::addon::PVREPGTag tag;
-    unsigned int broadcastId = static_cast<unsigned int>(channelUid ^ (eStart << 16) ^ (eStart >> 16) ^ eEnd);
-
-    tag.SetUniqueBroadcastId(broadcastId);
-    tag.SetUniqueChannelId(channelUid);
-    tag.SetStartTime(static_cast<time_t>(eStart));
-    tag.SetEndTime(static_cast<time_t>(eEnd));
+    if (event.start == 0 || event.end == 0 || event.end <= event.start) continue;
 
-    std::string title;
     if (epgItem.contains("title") && epgItem["title"].is_string())
-      title = epgItem["title"].get<std::string>();
-    if (!title.empty())
-      tag.SetTitle(title);
-
-    // NOTE: verified against live curl output (magentaeu_at, 2026-07-24) that this
-    // endpoint only ever sends a single "plot" field - there is no separate
-    // "description" field. The previous mapping (plot -> SetPlotOutline,
-    // description -> SetPlot) meant SetPlot() was never actually called, so Kodi's
-    // Info dialog synopsis was silently empty for every program. We now map "plot"
-    // to both SetPlot (Info dialog) and SetPlotOutline (EPG grid blurb).
-    // If the backend ever starts sending a distinct "description" field for the
-    // full synopsis, split this back into two mappings.
-    if (epgItem.contains("plot") && epgItem["plot"].is_string()) {
-      std::string plot = epgItem["plot"].get<std::string>();
-      if (!plot.empty()) {
-        tag.SetPlot(plot);
-        tag.SetPlotOutline(plot);
-      }
-    }
-
-    if (epgItem.contains("icon") && epgItem["icon"].is_string()) {
-      std::string icon = epgItem["icon"].get<std::string>();
-      if (!icon.empty())
-        tag.SetIconPath(icon);
+      event.title = epgItem["title"].get<std::string>();
+    if (epgItem.contains("plot") && epgItem["plot"].is_string())
+      event.plot = epgItem["plot"].get<std::string>();
+    if (epgItem.contains("icon") && epgItem["icon"].is_string())
+      event.icon = epgItem["icon"].get<std::string>();
+    if (epgItem.contains("genre") && epgItem["genre"].is_number_integer()) {
+      event.genre = epgItem["genre"].get<int>();
+      event.hasGenre = true;
     }
+    if (epgItem.contains("season_number") && epgItem["season_number"].is_number_integer())
+      event.seasonNumber = std::max(0, epgItem["season_number"].get<int>());
+    if (epgItem.contains("episode_number") && epgItem["episode_number"].is_number_integer())
+      event.episodeNumber = std::max(0, epgItem["episode_number"].get<int>());
+    if (epgItem.contains("episode_name") && epgItem["episode_name"].is_string())
+      event.episodeName = epgItem["episode_name"].get<std::string>();
+
+    events.push_back(std::move(event));
+  }
+  return true;
+}
 
-    if (epgItem.contains("genre") && epgItem["genre"].is_number_integer())
-      tag.SetGenreType(epgItem["genre"].get<int>());
-
-    // Only set season/episode numbers if they're valid (greater than 0)
-    if (epgItem.contains("season_number") && epgItem["season_number"].is_number_integer()) {
-      int seasonNum = epgItem["season_number"].get<int>();
-      if (seasonNum > 0)
-        tag.SetSeriesNumber(seasonNum);
-    }
-    if (epgItem.contains("episode_number") && epgItem["episode_number"].is_number_integer()) {
-      int episodeNum = epgItem["episode_number"].get<int>();
-      if (episodeNum > 0)
-        tag.SetEpisodeNumber(episodeNum);
-    }
+bool EPGManager::ParseEPGResponse(const std::string& response,
+                                   const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                                   std::vector<EPGEvent>& events) {
+  nlohmann::json document;
+  if (!parseJson(response, document)) return false;
+  std::vector<EPGEvent> parsed;
+  if (!ExtractEvents(document, parsed)) return false;
+  events = std::move(parsed);
+  return true;
+}
 
-    if (epgItem.contains("episode_name") && epgItem["episode_name"].is_string()) {
-      std::string epName = epgItem["episode_name"].get<std::string>();
-      if (!epName.empty())
-        tag.SetEpisodeName(epName);
+bool EPGManager::ParseEPGStream(std::istream& stream, int channelUid, std::vector<EPGEvent>& events) {
+  std::vector<EPGEvent> decoded;
+  EPGSaxHandler handler(decoded);
+  bool parsed = false;
+  try {
+    // Same format sniffing as Utils::ParseJsonResponse; peek() leaves the
+    // byte in the stream for the parser.
+    int firstByte = stream.peek();
+    auto format = nlohmann::json::input_format_t::json;
+    if (firstByte != std::char_traits<char>::eof()) {
+      switch (Utils::DetectWireFormat(static_cast<unsigned char>(firstByte))) {
+        case Utils::WireFormat::CBOR: format = nlohmann::json::input_format_t::cbor; break;
+        case Utils::WireFormat::MSGPACK: format = nlohmann::json::input_format_t::msgpack; break;
+        default: break;
+      }
     }
-
-    parsedTags.push_back({std::move(tag), eStart, eEnd, std::move(title)});
+    parsed = nlohmann::json::sax_parse(stream, &handler, format);
+  } catch (const std::exception& e) {
+    kodi::Log(ADDON_LOG_ERROR, "EPG stream parse failed for channel %d: %s", channelUid, e.what());
+    return false;
   }
+  if (!parsed || !handler.Succeeded()) return false;
+
+  events = std::move(decoded);
+  return true;
+}
 
+void EPGManager::AddEvents(const std::vector<EPGEvent>& events, int channelUid,
+                           kodi::addon::PVREPGTagsResultSet& results) {
   // De-duplication.
   //
   // IMPORTANT - this is not a simple "identical entry appears twice" bug. Live curl
@@ -111,75 +112,429 @@ bool EPGManager::ParseEPGResponse(const std::string& response,
   // drop it and log a WARNING (rather than picking silently) so this is visible in
   // logs. Default behavior keeps whichever version starts earlier after sorting -
   // that is a reasonable default, not a verified-correct choice.
-  // Sort indices rather than the ParsedTag structs themselves: kodi::addon::PVREPGTag
-  // (a CStructHdl wrapper around a C struct handle) is not move-assignable, which makes
-  // ParsedTag itself non-move-assignable, which std::sort on the structs directly needs.
-  // Sorting plain size_t indices sidesteps that entirely - parsedTags never gets reordered
-  // in place, we just read it through the sorted index order below.
-  std::vector<size_t> order(parsedTags.size());
+  // Sort indices rather than the events themselves - cheaper than moving the
+  // strings around, and keeps the tie order for equal start times exactly what
+  // it was when this sorted the (non-move-assignable) PVREPGTag structs' indices.
+  std::vector<size_t> order(events.size());
   for (size_t i = 0; i < order.size(); ++i) order[i] = i;
-  std::sort(order.begin(), order.end(), [&parsedTags](size_t a, size_t b) {
-    return parsedTags[a].start < parsedTags[b].start;
+  std::sort(order.begin(), order.end(), [&events](size_t a, size_t b) {
+    return events[a].start < events[b].start;
   });
 
   uint64_t lastAcceptedEnd = 0;
-  std::string lastAcceptedTitle;
-  bool haveAccepted = false;
+  const std::string* lastAcceptedTitle = nullptr;
 
   for (size_t idx : order) {
-    ParsedTag& pt = parsedTags[idx];
-    if (haveAccepted && !pt.title.empty() && pt.title == lastAcceptedTitle &&
-        pt.start < lastAcceptedEnd) {
+    const EPGEvent& event = events[idx];
+    if (lastAcceptedTitle && !event.title.empty() && event.title == *lastAcceptedTitle &&
+        event.start < lastAcceptedEnd) {
       kodi::Log(ADDON_LOG_WARNING,
                 "EPG dedup: dropping overlapping duplicate '%s' start=%llu end=%llu on "
                 "channel %d (kept earlier version ending at %llu) - two schedule "
                 "versions may be present in the feed, verify with backend which is "
                 "correct",
-                pt.title.c_str(), (unsigned long long)pt.start, (unsigned long long)pt.end,
+                event.title.c_str(), (unsigned long long)event.start, (unsigned long long)event.end,
                 channelUid, (unsigned long long)lastAcceptedEnd);
       continue;
     }
 
-    results.Add(pt.tag);
-    lastAcceptedEnd = pt.end;
-    lastAcceptedTitle = pt.title;
-    haveAccepted = true;
+    results.Add(MakeTag(event, channelUid));
+    lastAcceptedEnd = event.end;
+    lastAcceptedTitle = &event.title;
   }
+}
 
-  return true;
+kodi::addon::PVREPGTag EPGManager::MakeTag(const EPGEvent& event, int channelUid) {
+  kodi::addon::PVREPGTag tag;
+  unsigned int broadcastId = static_cast<unsigned int>(channelUid ^ (event.start << 16) ^ (event.start >> 16) ^ event.end);
+
+  tag.SetUniqueBroadcastId(broadcastId);
+  tag.SetUniqueChannelId(channelUid);
+  tag.SetStartTime(static_cast<time_t>(event.start));
+  tag.SetEndTime(static_cast<time_t>(event.end));
+
+  if (!event.title.empty())
+    tag.SetTitle(event.title);
+
+  // NOTE: verified against live curl output (magentaeu_at, 2026-07-24) that this
+  // endpoint only ever sends a single "plot" field - there is no separate
+  // "description" field. The previous mapping (plot -> SetPlotOutline,
+  // description -> SetPlot) meant SetPlot() was never actually called, so Kodi's
+  // Info dialog synopsis was silently empty for every program. We now map "plot"
+  // to both SetPlot (Info dialog) and SetPlotOutline (EPG grid blurb).
+  // If the backend ever starts sending a distinct "description" field for the
+  // full synopsis, split this back into two mappings.
+  if (!event.plot.empty()) {
+    tag.SetPlot(event.plot);
+    tag.SetPlotOutline(event.plot);
+  }
+
+  if (!event.icon.empty())
+    tag.SetIconPath(event.icon);
+
+  if (event.hasGenre)
+    tag.SetGenreType(event.genre);
+
+  // Only set season/episode numbers if they're valid (greater than 0)
+  if (event.seasonNumber > 0)
+    tag.SetSeriesNumber(event.seasonNumber);
+  if (event.episodeNumber > 0)
+    tag.SetEpisodeNumber(event.episodeNumber);
+
+  if (!event.episodeName.empty())
+    tag.SetEpisodeName(event.episodeName);
+
+  return tag;
 }
 
 // Original signature - preserved for any other call sites, delegates to extended version.
 bool EPGManager::GetEPGForChannel(int channelUid, time_t start, time_t end,
                                   const std::function<std::string(const std::string&)>& httpGet,
                                   const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                  const std::function<bool(int, UltimateChannel&)>& getChannelByUid,
+                                  const std::function<bool(int, ChannelView&)>& getChannelByUid,
                                   kodi::addon::PVREPGTagsResultSet& results) {
   return GetEPGForChannel(channelUid, start, end, httpGet, parseJson, getChannelByUid,
                           results, nullptr, false);
 }
 
-// Extended signature with optional database-EPG-service support.
-//
-// Contract for httpGetAbsolute: it receives a path that already starts with "/" and already
-// includes any versioning prefix (e.g. "/api/v1/providers/..."), and is expected to prepend
-// only scheme+host (m_epgServiceUrl) before making the request. It must NOT itself try to
-// detect/insert a version prefix - that logic belongs here, in one place, not split across
-// two layers (that split is what caused the double "/api/v1/api/v1/..." bug in an earlier draft).
+// Extended signature with optional database-EPG-service support. Only the
+// parts of the window the cache does not cover are fetched, widened to whole
+// buckets (see FETCH_BUCKET_SECONDS); the answer is then collected from the
+// cache, so fresh and held events go through AddEvents' de-duplication
+// together.
 bool EPGManager::GetEPGForChannel(int channelUid, time_t start, time_t end,
                                   const std::function<std::string(const std::string&)>& httpGet,
                                   const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                  const std::function<bool(int, UltimateChannel&)>& getChannelByUid,
+                                  const std::function<bool(int, ChannelView&)>& getChannelByUid,
                                   kodi::addon::PVREPGTagsResultSet& results,
                                   const std::function<std::string(const std::string&)>& httpGetAbsolute,
-                                  bool useDatabaseEpg) {
+                                  bool useDatabaseEpg,
+                                  const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetStream,
+                                  const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetAbsoluteStream) {
+  std::vector<EPGEvent> events;
+  if (!m_cache.IsEnabled()) {
+    if (!FetchEvents(channelUid, start, end, httpGet, parseJson, getChannelByUid, httpGetAbsolute, useDatabaseEpg,
+                     httpGetStream, httpGetAbsoluteStream, events)) {
+      return false;
+    }
+    AddEvents(events, channelUid, results);
+    return true;
+  }
+
+  // A failed fetch leaves its gap empty but still answers with the rest.
+  bool complete = true;
+  if (!m_cache.Missing(channelUid, start, end).empty()) {
+    complete = FillChannel(channelUid, start, end, httpGet, parseJson, getChannelByUid, httpGetAbsolute,
+                           useDatabaseEpg, httpGetStream, httpGetAbsoluteStream);
+  }
+  m_cache.Collect(channelUid, start, end, events);
+  AddEvents(events, channelUid, results);
+  return complete;
+}
+
+EPGManager::ChannelFetch::ChannelFetch(EPGManager& manager, int channelUid)
+    : m_manager(manager), m_channelUid(channelUid) {
+  {
+    std::lock_guard<std::mutex> lock(m_manager.m_inFlightMutex);
+    auto& slot = m_manager.m_inFlight[channelUid];
+    if (!slot) slot = std::make_shared<InFlight>();
+    if (slot->users++ > 0) m_manager.m_inFlightWaits++;
+    m_slot = slot;
+  }
+  m_slot->mutex.lock();
+}
+
+EPGManager::ChannelFetch::~ChannelFetch() {
+  m_slot->mutex.unlock();
+  std::lock_guard<std::mutex> lock(m_manager.m_inFlightMutex);
+  if (--m_slot->users == 0) m_manager.m_inFlight.erase(m_channelUid);
+}
+
+bool EPGManager::FillChannel(int channelUid, time_t start, time_t end,
+                             const std::function<std::string(const std::string&)>& httpGet,
+                             const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                             const std::function<bool(int, ChannelView&)>& getChannelByUid,
+                             const std::function<std::string(const std::string&)>& httpGetAbsolute,
+                             bool useDatabaseEpg,
+                             const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetStream,
+                             const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetAbsoluteStream) {
+  ChannelFetch inFlight(*this, channelUid);
+
+  bool complete = true;
+  auto fetch = [&](time_t from, time_t to) {
+    std::vector<EPGEvent> fetched;
+    if (!FetchEvents(channelUid, from, to, httpGet, parseJson, getChannelByUid, httpGetAbsolute, useDatabaseEpg,
+                     httpGetStream, httpGetAbsoluteStream, fetched)) {
+      complete = false;
+      return;
+    }
+    m_cache.Put(channelUid, from, to, fetched);
+    m_store.Write(channelUid, from, to, fetched);
+  };
+  // Gaps again: whoever held the channel before may have filled them.
+  for (const auto& [from, to] : ToBuckets(m_cache.Gaps(channelUid, start, end))) {
+    // Days the store has are cached from it; each run of the others is one
+    // request.
+    time_t fetchFrom = from;
+    for (time_t day = from; day < to; day += FETCH_BUCKET_SECONDS) {
+      std::vector<EPGEvent> stored;
+      std::chrono::seconds age;
+      if (!m_store.Read(channelUid, day, m_cache.GetTtl(), stored, age)) continue;
+      if (fetchFrom < day) fetch(fetchFrom, day);
+      m_cache.Put(channelUid, day, day + FETCH_BUCKET_SECONDS, stored, age);
+      fetchFrom = day + FETCH_BUCKET_SECONDS;
+    }
+    if (fetchFrom < to) fetch(fetchFrom, to);
+  }
+  return complete;
+}
+
+std::vector<std::pair<time_t, time_t>> EPGManager::ToBuckets(const std::vector<std::pair<time_t, time_t>>& gaps) {
+  std::vector<std::pair<time_t, time_t>> windows;
+  for (const auto& [gapStart, gapEnd] : gaps) {
+    time_t from = gapStart - (gapStart % FETCH_BUCKET_SECONDS + FETCH_BUCKET_SECONDS) % FETCH_BUCKET_SECONDS;
+    time_t to = gapEnd + (FETCH_BUCKET_SECONDS - gapEnd % FETCH_BUCKET_SECONDS) % FETCH_BUCKET_SECONDS;
+    // Gaps in one bucket, or in adjacent ones, share a request.
+    if (!windows.empty() && from <= windows.back().second) {
+      windows.back().second = std::max(windows.back().second, to);
+    } else {
+      windows.emplace_back(from, to);
+    }
+  }
+  return windows;
+}
+
+size_t EPGManager::PrefetchEPG(const ChannelStore& channels, time_t start, time_t end,
+                               const std::function<std::string(const std::string&)>& httpGet,
+                               const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                               const std::function<bool(int, ChannelView&)>& getChannelByUid,
+                               const std::function<std::string(const std::string&)>& httpGetAbsolute,
+                               bool useDatabaseEpg,
+                               const FanOutExecutor& executor,
+                               const std::function<bool()>& cancelled) {
+  if (!m_cache.IsEnabled() || end <= start) return 0;
+  const auto started = std::chrono::steady_clock::now();
+  // Whole buckets, so the per-channel calls find the window covered.
+  std::tie(start, end) = ToBuckets({{start, end}}).front();
+
+  struct Batch {
+    std::string provider;
+    std::string country;
+    time_t start;
+    time_t end;
+    std::vector<std::string> channelIds;
+    std::vector<int> uids;  // parallel to channelIds
+  };
+  // A provider's channels stay together, in channel order, so its batches
+  // are consecutive and the first failure can stop the rest. Channels also
+  // batch by the days they still need, which after a restart are the same
+  // (new) days for nearly all of them.
+  using BatchKey = std::tuple<std::string_view, std::string_view, time_t, time_t>;
+  std::map<BatchKey, std::vector<Batch>> byProvider;
+  size_t cached = 0;
+  size_t fromStore = 0;
+  for (ChannelView channel : channels) {
+    if (channel.Provider().empty() || channel.ChannelId().empty()) continue;
+    const int uid = channel.ChannelNumber();
+    if (m_cache.Gaps(uid, start, end).empty()) {
+      cached++;
+      continue;
+    }
+    time_t fetchFrom = end;
+    time_t fetchTo = start;
+    for (time_t day = start; day < end; day += FETCH_BUCKET_SECONDS) {
+      std::vector<EPGEvent> stored;
+      std::chrono::seconds age;
+      if (m_store.Read(uid, day, m_cache.GetTtl(), stored, age)) {
+        m_cache.Put(uid, day, day + FETCH_BUCKET_SECONDS, stored, age);
+        continue;
+      }
+      fetchFrom = std::min(fetchFrom, day);
+      fetchTo = day + FETCH_BUCKET_SECONDS;
+    }
+    if (fetchFrom >= fetchTo) {
+      cached++;
+      fromStore++;
+      continue;
+    }
+    auto& batches = byProvider[{channel.Provider(), channel.Country(), fetchFrom, fetchTo}];
+    if (batches.empty() || batches.back().channelIds.size() >= PREFETCH_BATCH_CHANNELS) {
+      batches.push_back({std::string(channel.Provider()), std::string(channel.Country()), fetchFrom, fetchTo, {}, {}});
+    }
+    batches.back().channelIds.emplace_back(channel.ChannelId());
+    batches.back().uids.push_back(uid);
+  }
+  std::vector<Batch> batches;
+  for (auto& [key, providerBatches] : byProvider) {
+    for (auto& batch : providerBatches) batches.push_back(std::move(batch));
+  }
+
+  std::mutex mutex;
+  std::set<std::string> failedProviders;
+  std::vector<int> oneByOne;  // channels left to a request each
+  // False if the batch made no request: cancelled, or every channel in it
+  // was filled meanwhile.
+  auto runBatch = [&](size_t batchIndex) {
+    if (cancelled()) return false;
+    const Batch& batch = batches[batchIndex];
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (failedProviders.count(batch.provider)) {
+        oneByOne.insert(oneByOne.end(), batch.uids.begin(), batch.uids.end());
+        return true;
+      }
+    }
+
+    // Held for the whole request, so Kodi asking for one of these channels
+    // meanwhile waits for the batch instead of fetching the channel again.
+    // Channels Kodi fetched while the batch was queued are left out.
+    std::vector<std::unique_ptr<ChannelFetch>> inFlight;
+    std::vector<std::string> channelIds;
+    std::vector<int> uids;
+    for (size_t i = 0; i < batch.uids.size(); ++i) {
+      inFlight.push_back(std::make_unique<ChannelFetch>(*this, batch.uids[i]));
+      if (m_cache.Gaps(batch.uids[i], batch.start, batch.end).empty()) continue;
+      channelIds.push_back(batch.channelIds[i]);
+      uids.push_back(batch.uids[i]);
+    }
+    if (uids.empty()) return false;
+
+    std::unordered_map<std::string, std::vector<EPGEvent>> eventsByChannel;
+    std::vector<int> missed;
+    if (FetchBatch(batch.provider, batch.country, channelIds, batch.start, batch.end, httpGet, parseJson,
+                   httpGetAbsolute, useDatabaseEpg, eventsByChannel)) {
+      for (size_t i = 0; i < uids.size(); ++i) {
+        auto events = eventsByChannel.find(channelIds[i]);
+        if (events == eventsByChannel.end()) {
+          missed.push_back(uids[i]);
+          continue;
+        }
+        m_cache.Put(uids[i], batch.start, batch.end, events->second);
+        m_store.Write(uids[i], batch.start, batch.end, events->second);
+      }
+    } else {
+      missed = uids;
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!cancelled() && failedProviders.insert(batch.provider).second) {
+        kodi::Log(ADDON_LOG_INFO, "EPG prefetch: no bulk EPG for provider %s, using per-channel requests",
+                  batch.provider.c_str());
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    cached += uids.size() - missed.size();
+    oneByOne.insert(oneByOne.end(), missed.begin(), missed.end());
+    return true;
+  };
+
+  // One probe per provider first: a backend without the bulk endpoint then
+  // sees one failing request per provider, not one per worker, and the
+  // provider's other batches go straight to per-channel requests.
+  std::map<std::string, std::vector<size_t>> unprobed;  // provider -> batch indices, in order
+  for (size_t i = 0; i < batches.size(); ++i) unprobed[batches[i].provider].push_back(i);
+  std::vector<size_t> probed;  // batches of providers whose probe made its request
+  while (!unprobed.empty() && !cancelled()) {
+    std::vector<size_t> probes;
+    for (const auto& [provider, indices] : unprobed) probes.push_back(indices.front());
+    std::vector<char> requested(probes.size(), 0);
+    executor.Run(probes.size(), [&](size_t index) { requested[index] = runBatch(probes[index]); });
+    for (size_t i = 0; i < probes.size(); ++i) {
+      // A probe that made no request leaves the provider's next batch to
+      // probe in another round.
+      auto provider = unprobed.find(batches[probes[i]].provider);
+      provider->second.erase(provider->second.begin());
+      if (requested[i]) probed.insert(probed.end(), provider->second.begin(), provider->second.end());
+      if (requested[i] || provider->second.empty()) unprobed.erase(provider);
+    }
+  }
+  executor.Run(probed.size(), [&](size_t index) { runBatch(probed[index]); });
+
+  // Same path as Kodi's own calls, so a channel Kodi is already fetching is
+  // waited for rather than requested twice.
+  std::sort(oneByOne.begin(), oneByOne.end());
+  std::atomic<size_t> filled{0};
+  executor.Run(oneByOne.size(), [&](size_t index) {
+    if (cancelled()) return;
+    if (FillChannel(oneByOne[index], start, end, httpGet, parseJson, getChannelByUid, httpGetAbsolute,
+                    useDatabaseEpg, nullptr, nullptr)) {
+      filled++;
+    }
+  });
+  cached += filled.load();
+
+  kodi::Log(ADDON_LOG_INFO,
+            "EPG prefetch: %zu of %zu channels cached (%zu from the store, %zu channel by channel) in %lld ms%s",
+            cached, channels.Size(), fromStore, filled.load(),
+            static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                       std::chrono::steady_clock::now() - started).count()),
+            cancelled() ? " (cancelled)" : "");
+  return cached;
+}
+
+bool EPGManager::FetchBatch(const std::string& provider, const std::string& country,
+                            const std::vector<std::string>& channelIds, time_t start, time_t end,
+                            const std::function<std::string(const std::string&)>& httpGet,
+                            const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                            const std::function<std::string(const std::string&)>& httpGetAbsolute,
+                            bool useDatabaseEpg,
+                            std::unordered_map<std::string, std::vector<EPGEvent>>& eventsByChannel) {
+  // Same query as the per-channel endpoints, plus the channel list; ids are
+  // encoded individually so a comma inside one cannot split it.
+  std::ostringstream query;
+  query << "/epg?channel_ids=";
+  for (size_t i = 0; i < channelIds.size(); ++i) {
+    if (i > 0) query << ",";
+    query << Utils::UrlEncode(channelIds[i]);
+  }
+  query << "&start_time=" << start << "&end_time=" << end;
+  if (!country.empty()) query << "&country=" << Utils::UrlEncode(country);
+
+  nlohmann::json document;
+  if (useDatabaseEpg && httpGetAbsolute) {
+    std::string response = httpGetAbsolute("/api/v1/providers/" + Utils::UrlPathEncode(provider) + query.str());
+    if (!response.empty() && parseJson(response, document) && ExtractBatch(document, eventsByChannel)) return true;
+    kodi::Log(ADDON_LOG_DEBUG, "Database bulk EPG failed for provider %s, falling back to backend",
+              provider.c_str());
+  }
+
+  std::string response = httpGet("/api/providers/" + Utils::UrlPathEncode(provider) + query.str());
+  return !response.empty() && parseJson(response, document) && ExtractBatch(document, eventsByChannel);
+}
+
+bool EPGManager::ExtractBatch(const nlohmann::json& document,
+                              std::unordered_map<std::string, std::vector<EPGEvent>>& eventsByChannel) {
+  if (!document.contains("channels") || !document["channels"].is_array()) return false;
+
+  for (const auto& entry : document["channels"]) {
+    if (!entry.is_object() || !entry.contains("channel_id") || !entry["channel_id"].is_string()) continue;
+    // Each entry has the per-channel response's shape.
+    std::vector<EPGEvent> events;
+    if (!ExtractEvents(entry, events)) continue;
+    eventsByChannel[entry["channel_id"].get<std::string>()] = std::move(events);
+  }
+  return true;
+}
+
+// Contract for httpGetAbsolute: it receives a path that already starts with "/" and already
+// includes any versioning prefix (e.g. "/api/v1/providers/..."), and is expected to prepend
+// only scheme+host (m_epgServiceUrl) before making the request. It must NOT itself try to
+// detect/insert a version prefix - that logic belongs here, in one place, not split across
+// two layers (that split is what caused the double "/api/v1/api/v1/..." bug in an earlier draft).
+bool EPGManager::FetchEvents(int channelUid, time_t start, time_t end,
+                             const std::function<std::string(const std::string&)>& httpGet,
+                             const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                             const std::function<bool(int, ChannelView&)>& getChannelByUid,
+                             const std::function<std::string(const std::string&)>& httpGetAbsolute,
+                             bool useDatabaseEpg,
+                             const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetStream,
+                             const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetAbsoluteStream,
+                             std::vector<EPGEvent>& events) {
   std::string provider, channelId, country;
-  UltimateChannel channel;
+  ChannelView channel;
 
   if (!getChannelByUid(channelUid, channel)) return false;
-  provider = channel.provider;
-  channelId = channel.channelId;
-  country = channel.country;
+  provider = channel.Provider();
+  channelId = channel.ChannelId();
+  country = channel.Country();
 
   if (useDatabaseEpg && httpGetAbsolute) {
     std::ostringstream dbUrl;
@@ -188,16 +543,27 @@ bool EPGManager::GetEPGForChannel(int channelUid, time_t start, time_t end,
           << "?start_time=" << start << "&end_time=" << end;
     if (!country.empty()) dbUrl << "&country=" << Utils::UrlEncode(country);
 
-    // Single call - httpGetAbsolute performs the request and returns the response body directly.
-    std::string dbResponse = httpGetAbsolute(dbUrl.str());
-
-    if (!dbResponse.empty()) {
-      if (ParseEPGResponse(dbResponse, channelUid, parseJson, results)) {
+    if (httpGetAbsoluteStream) {
+      // Events are only handed out once the whole document parsed, so a
+      // failure here leaves events untouched for the backend fallback.
+      if (httpGetAbsoluteStream(dbUrl.str(), [channelUid, &events](std::istream& stream) {
+            return ParseEPGStream(stream, channelUid, events);
+          })) {
         return true;
       }
-      kodi::Log(ADDON_LOG_WARNING, "Database EPG parse failed for channel %d, falling back to backend", channelUid);
+      kodi::Log(ADDON_LOG_WARNING, "Database EPG fetch/parse failed for channel %d, falling back to backend", channelUid);
     } else {
-      kodi::Log(ADDON_LOG_WARNING, "Database EPG empty response for channel %d, falling back to backend", channelUid);
+      // Single call - httpGetAbsolute performs the request and returns the response body directly.
+      std::string dbResponse = httpGetAbsolute(dbUrl.str());
+
+      if (!dbResponse.empty()) {
+        if (ParseEPGResponse(dbResponse, parseJson, events)) {
+          return true;
+        }
+        kodi::Log(ADDON_LOG_WARNING, "Database EPG parse failed for channel %d, falling back to backend", channelUid);
+      } else {
+        kodi::Log(ADDON_LOG_WARNING, "Database EPG empty response for channel %d, falling back to backend", channelUid);
+      }
     }
     // Falls through to the backend API path below.
   }
@@ -208,10 +574,16 @@ bool EPGManager::GetEPGForChannel(int channelUid, time_t start, time_t end,
       << "?start_time=" << start << "&end_time=" << end;
   if (!country.empty()) url << "&country=" << Utils::UrlEncode(country);
 
+  if (httpGetStream) {
+    return httpGetStream(url.str(), [channelUid, &events](std::istream& stream) {
+      return ParseEPGStream(stream, channelUid, events);
+    });
+  }
+
   std::string response = httpGet(url.str());
   if (response.empty()) return false;
 
-  return ParseEPGResponse(response, channelUid, parseJson, results);
+  return ParseEPGResponse(response, parseJson, events);
 }
 
 bool EPGManager::IsEPGTagRecordable(const kodi::addon::PVREPGTag& tag, bool& isRecordable) {
@@ -250,7 +622,7 @@ bool EPGManager::GetEPGTagStreamProperties(const kodi::addon::PVREPGTag& tag,
                                            const std::function<std::string(const std::string&)>& httpGet,
                                            const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
                                            const std::function<bool(int, std::string&, std::string&, int&)>& getChannelInfo,
-                                           const std::function<bool(int, UltimateChannel&)>& getChannelByUid,
+                                           const std::function<bool(int, ChannelView&)>& getChannelByUid,
                                            const std::function<bool()>& isBackendAvailable,
                                            const std::function<bool(const std::string&)>& retryBackendCall,
                                            const std::function<std::string(const std::string&, const std::string&)>& getManifestUrl,
@@ -269,7 +641,7 @@ bool EPGManager::GetEPGTagStreamProperties(const kodi::addon::PVREPGTag& tag,
   if (!getChannelInfo(channelUid, provider, channelId, catchupHours)) return false;
   if (catchupHours <= 0) return false;
 
-  UltimateChannel channel;
+  ChannelView channel;
   if (!getChannelByUid(channelUid, channel)) return false;
 
   if (!isBackendAvailable() && !retryBackendCall("EPG stream playback")) return false;
@@ -322,7 +694,7 @@ bool EPGManager::GetEPGTagStreamProperties(const kodi::addon::PVREPGTag& tag,
   // epg_id/country are only sent when the template asks for them. If the template requires
   // {country} but we have none for this channel, that's a data problem worth surfacing rather
   // than silently leaving the literal placeholder in the URL.
-  if (hasPlaceholder("{country}") && channel.country.empty()) {
+  if (hasPlaceholder("{country}") && channel.Country().empty()) {
     kodi::Log(ADDON_LOG_WARNING,
               "catchup_stream_url_template for %s/%s requires {country} but channel has none set",
               provider.c_str(), channelId.c_str());
@@ -332,7 +704,7 @@ bool EPGManager::GetEPGTagStreamProperties(const kodi::addon::PVREPGTag& tag,
   substitute("{start_time}", std::to_string(tag.GetStartTime()));
   substitute("{end_time}", std::to_string(tag.GetEndTime()));
   substitute("{epg_id}", std::to_string(broadcastId));
-  if (hasPlaceholder("{country}")) substitute("{country}", channel.country);
+  if (hasPlaceholder("{country}")) substitute("{country}", std::string(channel.Country()));
 
   properties.emplace_back(PVR_STREAM_PROPERTY_INPUTSTREAM, "inputstream.adaptive");
   properties.emplace_back(PVR_STREAM_PROPERTY_STREAMURL, streamUrl);
@@ -1,31 +1,85 @@
 #pragma once
 
 #include "Models.h"
+#include "ChannelStore.h"
+#include "EPGCache.h"
+#include "EPGStore.h"
+#include "FanOutExecutor.h"
 #include <kodi/addon-instance/PVR.h>
 #include <vector>
 #include <functional>
 #include <string>
+#include <istream>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 #include <nlohmann/json.hpp>
 
 class EPGManager {
 public:
     EPGManager() = default;
 
-    static bool GetEPGForChannel(int channelUid, time_t start, time_t end,
-                                 const std::function<std::string(const std::string&)>& httpGet,
-                                 const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                 const std::function<bool(int, UltimateChannel&)>& getChannelByUid,
-                                 kodi::addon::PVREPGTagsResultSet& results);
+    // getChannelByUid hands out views into a channel snapshot the caller
+    // holds for the duration of the call.
+    bool GetEPGForChannel(int channelUid, time_t start, time_t end,
+                          const std::function<std::string(const std::string&)>& httpGet,
+                          const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                          const std::function<bool(int, ChannelView&)>& getChannelByUid,
+                          kodi::addon::PVREPGTagsResultSet& results);
 
     // Extended overload: optionally try a database EPG service first via httpGetAbsolute,
     // falling back to the backend API (httpGet) on empty response or parse failure.
-    static bool GetEPGForChannel(int channelUid, time_t start, time_t end,
-                                 const std::function<std::string(const std::string&)>& httpGet,
-                                 const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                 const std::function<bool(int, UltimateChannel&)>& getChannelByUid,
-                                 kodi::addon::PVREPGTagsResultSet& results,
-                                 const std::function<std::string(const std::string&)>& httpGetAbsolute,
-                                 bool useDatabaseEpg);
+    // When the *Stream variants are set, responses are parsed with the SAX
+    // handler straight off the wire instead of being buffered and DOM-parsed;
+    // they call the consumer with the open body stream and return its result.
+    // Only the parts of the window the cache and the store lack are requested.
+    bool GetEPGForChannel(int channelUid, time_t start, time_t end,
+                          const std::function<std::string(const std::string&)>& httpGet,
+                          const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                          const std::function<bool(int, ChannelView&)>& getChannelByUid,
+                          kodi::addon::PVREPGTagsResultSet& results,
+                          const std::function<std::string(const std::string&)>& httpGetAbsolute,
+                          bool useDatabaseEpg,
+                          const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetStream = nullptr,
+                          const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetAbsoluteStream = nullptr);
+
+    EPGCache& GetCache() { return m_cache; }
+    // Consulted (when open) for the days the cache is missing before the
+    // network; everything fetched is written to it. Only days written less
+    // than the cache TTL ago are used, and they enter the cache with the
+    // TTL they have left, so a day is refetched once it is TTL old.
+    EPGStore& GetStore() { return m_store; }
+
+    // Gaps in the cached EPG are fetched as whole UTC days. Once every cached
+    // range is bucket-aligned, a window that moves by an hour needs no
+    // request at all until it reaches the next day.
+    static constexpr time_t FETCH_BUCKET_SECONDS = 24 * 60 * 60;
+
+    // Fills the cache for [start, end), widened to whole buckets, ahead of
+    // Kodi's per-channel calls; meant for a background thread, with executor
+    // bounding the concurrent requests and the fetch functions any rate
+    // limit. Days the store has are cached from it and not requested. The
+    // other channels are batched per provider and country (the EPG endpoints
+    // take both), at most PREFETCH_BATCH_CHANNELS to a request, database EPG
+    // service first if enabled, then the backend. Each provider's first
+    // batch goes alone; the rest follow only if it succeeded. Channels a
+    // response leaves out, and every channel of a provider whose bulk
+    // endpoint failed, are then fetched one by one. Stops early once cancelled() is true. Returns
+    // the number of channels cached.
+    size_t PrefetchEPG(const ChannelStore& channels, time_t start, time_t end,
+                       const std::function<std::string(const std::string&)>& httpGet,
+                       const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                       const std::function<bool(int, ChannelView&)>& getChannelByUid,
+                       const std::function<std::string(const std::string&)>& httpGetAbsolute,
+                       bool useDatabaseEpg,
+                       const FanOutExecutor& executor,
+                       const std::function<bool()>& cancelled);
+    static constexpr size_t PREFETCH_BATCH_CHANNELS = 50;
+
+    // Calls that found their channel's fetch in flight and waited for it.
+    uint64_t GetInFlightWaitCount() const { return m_inFlightWaits.load(); }
 
     static bool IsEPGTagRecordable(const kodi::addon::PVREPGTag& tag, bool& isRecordable);
     static bool IsEPGTagPlayable(const kodi::addon::PVREPGTag& tag, bool& isPlayable,
@@ -45,7 +99,7 @@ public:
                                           const std::function<std::string(const std::string&)>& httpGet,
                                           const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
                                           const std::function<bool(int, std::string&, std::string&, int&)>& getChannelInfo,
-                                          const std::function<bool(int, UltimateChannel&)>& getChannelByUid,
+                                          const std::function<bool(int, ChannelView&)>& getChannelByUid,
                                           const std::function<bool()>& isBackendAvailable,
                                           const std::function<bool(const std::string&)>& retryBackendCall,
                                           const std::function<std::string(const std::string&, const std::string&)>& getManifestUrl,
@@ -55,9 +109,77 @@ public:
                                           std::string& streamHeadersBase64);
 
 private:
-    // Shared parsing logic - single source of truth for EPG JSON -> PVREPGTag mapping.
+    // Requests [start, end) for the channel (database EPG service first if
+    // enabled, then the backend) and decodes it into events.
+    static bool FetchEvents(int channelUid, time_t start, time_t end,
+                            const std::function<std::string(const std::string&)>& httpGet,
+                            const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                            const std::function<bool(int, ChannelView&)>& getChannelByUid,
+                            const std::function<std::string(const std::string&)>& httpGetAbsolute,
+                            bool useDatabaseEpg,
+                            const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetStream,
+                            const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetAbsoluteStream,
+                            std::vector<EPGEvent>& events);
+    struct InFlight {
+        std::mutex mutex;
+        int users = 0;  // holder and waiters
+    };
+    // One fetch per channel at a time: a caller arriving while the channel is
+    // being fetched (by the prefetch or another call) waits for that fetch
+    // and then finds its result in the cache.
+    class ChannelFetch {
+    public:
+        ChannelFetch(EPGManager& manager, int channelUid);
+        ~ChannelFetch();
+        ChannelFetch(const ChannelFetch&) = delete;
+        ChannelFetch& operator=(const ChannelFetch&) = delete;
+
+    private:
+        EPGManager& m_manager;
+        int m_channelUid;
+        std::shared_ptr<InFlight> m_slot;
+    };
+
+    // Makes the cache cover [start, end) for the channel inside its
+    // ChannelFetch: days the store has are loaded, each run of the others is
+    // one request. False if a fetch failed.
+    bool FillChannel(int channelUid, time_t start, time_t end,
+                     const std::function<std::string(const std::string&)>& httpGet,
+                     const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                     const std::function<bool(int, ChannelView&)>& getChannelByUid,
+                     const std::function<std::string(const std::string&)>& httpGetAbsolute,
+                     bool useDatabaseEpg,
+                     const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetStream,
+                     const std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)>& httpGetAbsoluteStream);
+
+    // One bulk request: {"channels": [{"channel_id": ..., "epg": [...]}, ...]}.
+    // eventsByChannel gets an entry for every channel the response carries.
+    static bool FetchBatch(const std::string& provider, const std::string& country,
+                           const std::vector<std::string>& channelIds, time_t start, time_t end,
+                           const std::function<std::string(const std::string&)>& httpGet,
+                           const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                           const std::function<std::string(const std::string&)>& httpGetAbsolute,
+                           bool useDatabaseEpg,
+                           std::unordered_map<std::string, std::vector<EPGEvent>>& eventsByChannel);
+    static bool ExtractBatch(const nlohmann::json& document,
+                             std::unordered_map<std::string, std::vector<EPGEvent>>& eventsByChannel);
+    // Widens gaps to bucket boundaries, merging the ones that then touch.
+    static std::vector<std::pair<time_t, time_t>> ToBuckets(const std::vector<std::pair<time_t, time_t>>& gaps);
+    // Both leave events untouched unless the whole response decoded.
     static bool ParseEPGResponse(const std::string& response,
-                                 int channelUid,
                                  const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                 kodi::addon::PVREPGTagsResultSet& results);
+                                 std::vector<EPGEvent>& events);
+    static bool ParseEPGStream(std::istream& stream, int channelUid, std::vector<EPGEvent>& events);
+
+    static bool ExtractEvents(const nlohmann::json& document, std::vector<EPGEvent>& events);
+    // Sorts, drops overlapping same-titled duplicates and adds the rest as tags.
+    static void AddEvents(const std::vector<EPGEvent>& events, int channelUid,
+                          kodi::addon::PVREPGTagsResultSet& results);
+    static kodi::addon::PVREPGTag MakeTag(const EPGEvent& event, int channelUid);
+
+    EPGCache m_cache;
+    EPGStore m_store;
+    std::mutex m_inFlightMutex;
+    std::unordered_map<int, std::shared_ptr<InFlight>> m_inFlight;
+    std::atomic<uint64_t> m_inFlightWaits{0};
 };
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "EPGSaxHandler.h"
+#include <kodi/General.h>
+
+EPGSaxHandler::Field EPGSaxHandler::FieldForKey(const std::string& key) {
+  if (key == "start") return Field::START;
+  if (key == "end") return Field::END;
+  if (key == "title") return Field::TITLE;
+  if (key == "plot") return Field::PLOT;
+  if (key == "icon") return Field::ICON;
+  if (key == "genre") return Field::GENRE;
+  if (key == "season_number") return Field::SEASON;
+  if (key == "episode_number") return Field::EPISODE;
+  if (key == "episode_name") return Field::EPISODE_NAME;
+  return Field::NONE;
+}
+
+void EPGSaxHandler::ResetCurrentField() {
+  switch (m_field) {
+    case Field::START: m_item.start = 0; break;
+    case Field::END: m_item.end = 0; break;
+    case Field::TITLE: m_item.title.clear(); break;
+    case Field::PLOT: m_item.plot.clear(); break;
+    case Field::ICON: m_item.icon.clear(); break;
+    case Field::GENRE: m_item.genre = 0; m_item.hasGenre = false; break;
+    case Field::SEASON: m_item.seasonNumber = 0; break;
+    case Field::EPISODE: m_item.episodeNumber = 0; break;
+    case Field::EPISODE_NAME: m_item.episodeName.clear(); break;
+    case Field::NONE: break;
+  }
+}
+
+void EPGSaxHandler::SetInteger(int64_t value) {
+  // Same conversions as json::get<uint64_t>() / get<int>() on the DOM.
+  switch (m_field) {
+    case Field::START: m_item.start = static_cast<uint64_t>(value); break;
+    case Field::END: m_item.end = static_cast<uint64_t>(value); break;
+    case Field::GENRE: m_item.genre = static_cast<int>(value); m_item.hasGenre = true; break;
+    case Field::SEASON: m_item.seasonNumber = std::max(0, static_cast<int>(value)); break;
+    case Field::EPISODE: m_item.episodeNumber = std::max(0, static_cast<int>(value)); break;
+    default: break;
+  }
+}
+
+void EPGSaxHandler::BeginValue() {
+  if (m_inItem && m_depth == 3) {
+    ResetCurrentField();
+  } else if (m_depth == 1 && m_nextIsEpg) {
+    // A later duplicate "epg" key replaces an earlier one (last key wins,
+    // as in the DOM); an array value re-arms this in start_array().
+    m_haveEpgArray = false;
+    m_pending.clear();
+  }
+  m_nextIsEpg = false;
+}
+
+bool EPGSaxHandler::null() {
+  BeginValue();
+  return true;
+}
+
+bool EPGSaxHandler::boolean(bool) {
+  return null();
+}
+
+bool EPGSaxHandler::number_integer(number_integer_t value) {
+  BeginValue();
+  if (m_inItem && m_depth == 3) SetInteger(value);
+  return true;
+}
+
+bool EPGSaxHandler::number_unsigned(number_unsigned_t value) {
+  BeginValue();
+  if (m_inItem && m_depth == 3) {
+    if (m_field == Field::START) m_item.start = value;
+    else if (m_field == Field::END) m_item.end = value;
+    else SetInteger(static_cast<int64_t>(value));
+  }
+  return true;
+}
+
+bool EPGSaxHandler::number_float(number_float_t, const string_t&) {
+  return null();
+}
+
+bool EPGSaxHandler::string(string_t& value) {
+  BeginValue();
+  if (m_inItem && m_depth == 3) {
+    switch (m_field) {
+      case Field::TITLE: m_item.title = std::move(value); break;
+      case Field::PLOT: m_item.plot = std::move(value); break;
+      case Field::ICON: m_item.icon = std::move(value); break;
+      case Field::EPISODE_NAME: m_item.episodeName = std::move(value); break;
+      default: break;
+    }
+  }
+  return true;
+}
+
+bool EPGSaxHandler::binary(binary_t&) {
+  return null();
+}
+
+bool EPGSaxHandler::start_object(std::size_t) {
+  BeginValue();
+  m_depth++;
+  if (m_depth == 3 && m_inEpgArray) {
+    m_inItem = true;
+    m_item = EPGEvent();
+    m_field = Field::NONE;
+  }
+  return true;
+}
+
+bool EPGSaxHandler::key(string_t& value) {
+  if (m_depth == 1) {
+    m_nextIsEpg = (value == "epg");
+  } else if (m_inItem && m_depth == 3) {
+    m_field = FieldForKey(value);
+  }
+  return true;
+}
+
+bool EPGSaxHandler::end_object() {
+  if (m_inItem && m_depth == 3) {
+    m_inItem = false;
+    // Backend occasionally sends malformed entries with zero or inverted
+    // timestamps - unusable for Kodi's EPG grid, skipped (as in the DOM path).
+    if (m_item.start != 0 && m_item.end != 0 && m_item.end > m_item.start) {
+      m_pending.push_back(std::move(m_item));
+    }
+  }
+  m_depth--;
+  if (m_depth == 0 && m_haveEpgArray) {
+    m_events.insert(m_events.end(), std::make_move_iterator(m_pending.begin()),
+                    std::make_move_iterator(m_pending.end()));
+    m_pending.clear();
+  }
+  return true;
+}
+
+bool EPGSaxHandler::start_array(std::size_t) {
+  bool isEpg = (m_depth == 1 && m_nextIsEpg);
+  BeginValue();
+  m_depth++;
+  if (isEpg) m_inEpgArray = true;
+  return true;
+}
+
+bool EPGSaxHandler::end_array() {
+  if (m_depth == 2 && m_inEpgArray) {
+    m_inEpgArray = false;
+    m_haveEpgArray = true;
+  }
+  m_depth--;
+  return true;
+}
+
+bool EPGSaxHandler::parse_error(std::size_t position, const std::string&,
+                                const nlohmann::detail::exception& ex) {
+  kodi::Log(ADDON_LOG_ERROR, "EPG stream parse error: %s (byte %zu)", ex.what(), position);
+  m_haveEpgArray = false;
+  m_pending.clear();
+  return false;
+}
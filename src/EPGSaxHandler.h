@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Models.h"
+#include <vector>
+#include <string>
+#include <nlohmann/json.hpp>
+
+// nlohmann::json SAX consumer for EPG responses ({"epg": [ {...}, ... ]}).
+// Builds EPGEvent entries directly while the response is parsed, without
+// materialising a DOM for the (often multi-megabyte) payload. Field mapping,
+// type checks and the skip rule for unusable timestamps mirror
+// EPGManager::ExtractEvents exactly, including nlohmann's last-key-wins
+// handling of duplicate object keys.
+class EPGSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+  explicit EPGSaxHandler(std::vector<EPGEvent>& events) : m_events(events) {}
+
+  // True once parsing finished and the document had an "epg" array at its
+  // top level (the DOM path's contains("epg") && is_array() check).
+  bool Succeeded() const { return m_haveEpgArray; }
+
+  bool null() override;
+  bool boolean(bool value) override;
+  bool number_integer(number_integer_t value) override;
+  bool number_unsigned(number_unsigned_t value) override;
+  bool number_float(number_float_t value, const string_t& raw) override;
+  bool string(string_t& value) override;
+  bool binary(binary_t& value) override;
+  bool start_object(std::size_t elements) override;
+  bool key(string_t& value) override;
+  bool end_object() override;
+  bool start_array(std::size_t elements) override;
+  bool end_array() override;
+  bool parse_error(std::size_t position, const std::string& lastToken,
+                   const nlohmann::detail::exception& ex) override;
+
+private:
+  enum class Field {
+    NONE, START, END, TITLE, PLOT, ICON, GENRE, SEASON, EPISODE, EPISODE_NAME
+  };
+
+  static Field FieldForKey(const std::string& key);
+
+  // Called at the start of every value. Inside an EPG item any value first
+  // resets the field it is assigned to (a later duplicate key of the wrong
+  // type must clear an earlier valid one, as in the DOM), then the typed
+  // handler applies it.
+  void BeginValue();
+  void ResetCurrentField();
+  void SetInteger(int64_t value);
+
+  std::vector<EPGEvent>& m_events;
+
+  // Depth 1 = root object, 2 = "epg" array, 3 = an item object; deeper
+  // containers inside items are skipped.
+  int m_depth = 0;
+  bool m_nextIsEpg = false;        // last root-level key was "epg"
+  bool m_inEpgArray = false;
+  bool m_haveEpgArray = false;
+  std::vector<EPGEvent> m_pending;  // events of the current "epg" array
+  bool m_inItem = false;
+  EPGEvent m_item;
+  Field m_field = Field::NONE;
+};
@@ -0,0 +1,407 @@
+#include "EPGStore.h"
+#include "MappedFile.h"
+#include "ModelFields.h"
+#include <kodi/General.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace {
+
+constexpr char MAGIC[8] = {'U', 'P', 'V', 'R', 'E', 'P', 'G', 'S'};
+
+// Below this a segment is not worth rewriting, however much of it is garbage.
+constexpr uint64_t COMPACT_MIN_BYTES = 256 * 1024;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t fieldsPerEvent;
+  uint64_t source;  // FNV-1a of the source string
+  int64_t dayStart;
+};
+
+struct BlockHeader {
+  int32_t channelUid;
+  uint32_t eventCount;
+  uint64_t stringsSize;  // unpadded; the string area is padded to 8 bytes
+  uint64_t checksum;     // FNV-1a over the slots and the padded string area
+  int64_t writtenAt;     // wall clock, for the age check in Read()
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(BlockHeader) % 8 == 0,
+              "EPG store structs must stay 8-byte aligned");
+
+uint64_t Fnv1a(const void* data, size_t size) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+uint64_t Align8(uint64_t size) { return (size + 7) & ~uint64_t{7}; }
+
+time_t FloorDay(time_t t) {
+  return t - ((t % EPGStore::DAY_SECONDS) + EPGStore::DAY_SECONDS) % EPGStore::DAY_SECONDS;
+}
+
+struct FieldCounter {
+  uint32_t count = 0;
+  template <class T> void operator()(const T&) { count++; }
+};
+
+uint32_t CountEventFields() {
+  EPGEvent event;
+  FieldCounter counter;
+  ModelFields::VisitEPGEvent(event, counter);
+  return counter.count;
+}
+
+const uint32_t EVENT_FIELDS = CountEventFields();
+
+class SlotWriter {
+public:
+  void operator()(const std::string& value) {
+    uint64_t offset = m_strings.size();
+    m_strings.append(value);
+    m_slots.push_back((offset << 32) | static_cast<uint32_t>(value.size()));
+  }
+  template <class N> void operator()(const N& value) {
+    static_assert(std::is_arithmetic_v<N>, "EPG event fields must be strings or numbers");
+    m_slots.push_back(static_cast<uint64_t>(static_cast<int64_t>(value)));
+  }
+
+  std::vector<uint64_t> m_slots;
+  std::string m_strings;
+};
+
+class SlotReader {
+public:
+  SlotReader(const uint64_t* slots, const char* strings, uint64_t stringsSize)
+      : m_slots(slots), m_strings(strings), m_stringsSize(stringsSize) {}
+
+  void operator()(std::string& value) {
+    uint64_t slot = *m_slots++;
+    uint64_t offset = slot >> 32;
+    uint64_t length = slot & 0xFFFFFFFFull;
+    if (offset + length > m_stringsSize) {
+      m_ok = false;
+      value.clear();
+      return;
+    }
+    value.assign(m_strings + offset, length);
+  }
+  template <class N> void operator()(N& value) {
+    value = static_cast<N>(static_cast<int64_t>(*m_slots++));
+  }
+
+  bool Ok() const { return m_ok; }
+
+private:
+  const uint64_t* m_slots;
+  const char* m_strings;
+  uint64_t m_stringsSize;
+  bool m_ok = true;
+};
+
+FileHeader MakeFileHeader(uint64_t source, time_t dayStart) {
+  FileHeader header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = EPGStore::VERSION;
+  header.fieldsPerEvent = EVENT_FIELDS;
+  header.source = source;
+  header.dayStart = static_cast<int64_t>(dayStart);
+  return header;
+}
+
+std::string EncodeBlock(int channelUid, const std::vector<const EPGEvent*>& events, time_t writtenAt) {
+  SlotWriter writer;
+  for (const EPGEvent* event : events) ModelFields::VisitEPGEvent(*event, writer);
+
+  std::string payload;
+  payload.reserve(writer.m_slots.size() * sizeof(uint64_t) + Align8(writer.m_strings.size()));
+  payload.append(reinterpret_cast<const char*>(writer.m_slots.data()), writer.m_slots.size() * sizeof(uint64_t));
+  payload.append(writer.m_strings);
+  payload.resize(writer.m_slots.size() * sizeof(uint64_t) + Align8(writer.m_strings.size()), '\0');
+
+  BlockHeader header{channelUid, static_cast<uint32_t>(events.size()), writer.m_strings.size(),
+                     Fnv1a(payload.data(), payload.size()), static_cast<int64_t>(writtenAt)};
+  std::string block(reinterpret_cast<const char*>(&header), sizeof(header));
+  block += payload;
+  return block;
+}
+
+}  // namespace
+
+EPGStore::EPGStore() = default;
+EPGStore::~EPGStore() = default;
+
+bool EPGStore::Open(const std::string& directory, const std::string& source, int retentionDays) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_segments.clear();
+  m_directory.clear();
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    kodi::Log(ADDON_LOG_WARNING, "EPG store: cannot create %s: %s", directory.c_str(), error.message().c_str());
+    return false;
+  }
+  m_directory = directory;
+  m_source = Fnv1a(source.data(), source.size());
+  m_retentionSeconds = std::max(0, retentionDays) * DAY_SECONDS;
+
+  std::vector<time_t> days;
+  std::vector<std::filesystem::path> leftovers;
+  for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+    const std::filesystem::path& path = it->path();
+    if (path.extension() == ".tmp") {
+      leftovers.push_back(path);
+      continue;
+    }
+    if (path.extension() != ".epg") continue;
+    const std::string stem = path.stem().string();
+    char* parsedEnd = nullptr;
+    const long long day = std::strtoll(stem.c_str(), &parsedEnd, 10);
+    if (stem.empty() || *parsedEnd != '\0' || day % DAY_SECONDS != 0) {
+      leftovers.push_back(path);
+      continue;
+    }
+    days.push_back(static_cast<time_t>(day));
+  }
+  for (const auto& path : leftovers) std::filesystem::remove(path, error);
+
+  for (time_t day : days) {
+    if (!LoadSegment(day, m_segments[day])) {
+      kodi::Log(ADDON_LOG_INFO, "EPG store: %s is from another source or version or unreadable, deleting",
+                SegmentPath(day).c_str());
+      RemoveSegment(day);
+    }
+  }
+  PurgeExpired(std::time(nullptr));
+
+  uint64_t bytes = 0;
+  for (const auto& [day, segment] : m_segments) bytes += segment.size;
+  kodi::Log(ADDON_LOG_INFO, "EPG store: %zu days, %llu bytes in %s", m_segments.size(),
+            static_cast<unsigned long long>(bytes), directory.c_str());
+  return true;
+}
+
+void EPGStore::Close() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_segments.clear();
+  m_directory.clear();
+}
+
+bool EPGStore::IsOpen() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return !m_directory.empty();
+}
+
+bool EPGStore::Read(int channelUid, time_t dayStart, std::chrono::seconds maxAge, std::vector<EPGEvent>& events,
+                    std::chrono::seconds& age) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto segment = m_segments.find(dayStart);
+  if (segment == m_segments.end()) return false;
+  auto block = segment->second.blocks.find(channelUid);
+  if (block == segment->second.blocks.end()) return false;
+
+  auto& mapping = segment->second.mapping;
+  if (!mapping) mapping = std::make_unique<MappedFile>(SegmentPath(dayStart));
+  const Block& location = block->second;
+  if (!mapping->Data() || mapping->Size() < location.offset + location.size) {
+    mapping.reset();
+    return false;
+  }
+
+  BlockHeader header;
+  std::memcpy(&header, mapping->Data() + location.offset, sizeof(header));
+  // A block written "in the future" means the clock was set back; its age
+  // is unknown, so it counts as stale too.
+  const std::chrono::seconds blockAge(static_cast<int64_t>(std::time(nullptr)) - header.writtenAt);
+  if (blockAge.count() < 0 || blockAge >= maxAge) return false;
+  const auto* slots = reinterpret_cast<const uint64_t*>(mapping->Data() + location.offset + sizeof(BlockHeader));
+  const auto* strings = reinterpret_cast<const char*>(slots + static_cast<uint64_t>(header.eventCount) * EVENT_FIELDS);
+  SlotReader reader(slots, strings, header.stringsSize);
+  std::vector<EPGEvent> decoded(header.eventCount);
+  for (auto& event : decoded) ModelFields::VisitEPGEvent(event, reader);
+  if (!reader.Ok()) return false;
+
+  events = std::move(decoded);
+  age = blockAge;
+  return true;
+}
+
+void EPGStore::Write(int channelUid, time_t start, time_t end, const std::vector<EPGEvent>& events) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_directory.empty()) return;
+
+  const time_t now = std::time(nullptr);
+  if (now / DAY_SECONDS != m_purgedDay) PurgeExpired(now);
+  const time_t cutoff = now - m_retentionSeconds;
+
+  for (time_t day = FloorDay(start + DAY_SECONDS - 1); day + DAY_SECONDS <= end; day += DAY_SECONDS) {
+    if (day + DAY_SECONDS <= cutoff) continue;
+    const uint64_t dayBegin = static_cast<uint64_t>(day);
+    const uint64_t dayEnd = static_cast<uint64_t>(day + DAY_SECONDS);
+    std::vector<const EPGEvent*> dayEvents;
+    for (const auto& event : events) {
+      if (event.start < dayEnd && event.end > dayBegin) dayEvents.push_back(&event);
+    }
+    Append(day, m_segments[day], channelUid, EncodeBlock(channelUid, dayEvents, now));
+  }
+}
+
+void EPGStore::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  while (!m_segments.empty()) RemoveSegment(m_segments.begin()->first);
+}
+
+std::string EPGStore::SegmentPath(time_t dayStart) const {
+  return (std::filesystem::path(m_directory) / (std::to_string(static_cast<long long>(dayStart)) + ".epg")).string();
+}
+
+bool EPGStore::LoadSegment(time_t dayStart, Segment& segment) {
+  MappedFile file(SegmentPath(dayStart));
+  if (!file.Data() || file.Size() < sizeof(FileHeader)) return false;
+
+  FileHeader header;
+  std::memcpy(&header, file.Data(), sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+      header.fieldsPerEvent != EVENT_FIELDS || header.source != m_source ||
+      header.dayStart != static_cast<int64_t>(dayStart)) {
+    return false;
+  }
+
+  // Later blocks of a channel supersede earlier ones. Scanning stops at the
+  // first block that is cut short or fails its checksum.
+  uint64_t offset = sizeof(FileHeader);
+  segment.liveBytes = sizeof(FileHeader);
+  while (file.Size() - offset >= sizeof(BlockHeader)) {
+    BlockHeader block;
+    std::memcpy(&block, file.Data() + offset, sizeof(block));
+    const uint64_t remaining = file.Size() - offset - sizeof(BlockHeader);
+    const uint64_t slotBytes = static_cast<uint64_t>(block.eventCount) * EVENT_FIELDS * sizeof(uint64_t);
+    if (slotBytes > remaining || block.stringsSize > remaining - slotBytes) break;
+    const uint64_t payloadSize = slotBytes + Align8(block.stringsSize);
+    if (payloadSize > remaining) break;
+    if (Fnv1a(file.Data() + offset + sizeof(BlockHeader), payloadSize) != block.checksum) break;
+
+    const uint64_t size = sizeof(BlockHeader) + payloadSize;
+    auto [it, inserted] = segment.blocks.try_emplace(block.channelUid, Block{offset, size});
+    if (!inserted) {
+      segment.liveBytes -= it->second.size;
+      it->second = Block{offset, size};
+    }
+    segment.liveBytes += size;
+    offset += size;
+  }
+  segment.size = file.Size();
+
+  if (offset != file.Size()) {
+    kodi::Log(ADDON_LOG_WARNING, "EPG store: %s has a torn tail, keeping %zu channels",
+              SegmentPath(dayStart).c_str(), segment.blocks.size());
+    return Compact(dayStart, segment);
+  }
+  return true;
+}
+
+bool EPGStore::Append(time_t dayStart, Segment& segment, int channelUid, const std::string& block) {
+  const std::string path = SegmentPath(dayStart);
+  const bool created = segment.size == 0;
+  {
+    std::ofstream out(path, std::ios::binary | (created ? std::ios::trunc : std::ios::app));
+    if (created) {
+      const FileHeader header = MakeFileHeader(m_source, dayStart);
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    if (!out.flush()) {
+      kodi::Log(ADDON_LOG_WARNING, "EPG store: write to %s failed", path.c_str());
+      out.close();
+      // Offsets past a partial write are unknown; start the day over.
+      RemoveSegment(dayStart);
+      return false;
+    }
+  }
+
+  if (created) segment.size = segment.liveBytes = sizeof(FileHeader);
+  auto [it, inserted] = segment.blocks.try_emplace(channelUid, Block{segment.size, block.size()});
+  if (!inserted) {
+    segment.liveBytes -= it->second.size;
+    it->second = Block{segment.size, block.size()};
+  }
+  segment.liveBytes += block.size();
+  segment.size += block.size();
+  segment.mapping.reset();
+
+  if (segment.size >= COMPACT_MIN_BYTES && segment.size > 2 * segment.liveBytes) Compact(dayStart, segment);
+  return true;
+}
+
+bool EPGStore::Compact(time_t dayStart, Segment& segment) {
+  const std::string path = SegmentPath(dayStart);
+  MappedFile file(path);
+  if (!file.Data()) return false;
+
+  std::vector<std::pair<int, Block>> blocks(segment.blocks.begin(), segment.blocks.end());
+  std::sort(blocks.begin(), blocks.end(),
+            [](const auto& a, const auto& b) { return a.second.offset < b.second.offset; });
+
+  const FileHeader header = MakeFileHeader(m_source, dayStart);
+  std::string content(reinterpret_cast<const char*>(&header), sizeof(header));
+  content.reserve(segment.liveBytes);
+  for (auto& [channelUid, block] : blocks) {
+    if (block.offset + block.size > file.Size()) return false;
+    const uint64_t offset = content.size();
+    content.append(reinterpret_cast<const char*>(file.Data() + block.offset), block.size);
+    block.offset = offset;
+  }
+
+  const std::string tempPath = path + ".tmp";
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    if (!out.flush()) {
+      kodi::Log(ADDON_LOG_WARNING, "EPG store: write to %s failed", tempPath.c_str());
+      out.close();
+      std::remove(tempPath.c_str());
+      return false;
+    }
+  }
+#ifdef _WIN32
+  std::remove(path.c_str());  // rename() does not replace on Windows
+#endif
+  if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+    kodi::Log(ADDON_LOG_WARNING, "EPG store: cannot replace %s", path.c_str());
+    std::remove(tempPath.c_str());
+    return false;
+  }
+
+  kodi::Log(ADDON_LOG_DEBUG, "EPG store: compacted %s from %llu to %zu bytes", path.c_str(),
+            static_cast<unsigned long long>(segment.size), content.size());
+  for (const auto& [channelUid, block] : blocks) segment.blocks[channelUid] = block;
+  segment.size = segment.liveBytes = content.size();
+  segment.mapping.reset();
+  return true;
+}
+
+void EPGStore::RemoveSegment(time_t dayStart) {
+  std::remove(SegmentPath(dayStart).c_str());
+  m_segments.erase(dayStart);
+}
+
+void EPGStore::PurgeExpired(time_t now) {
+  const time_t cutoff = now - m_retentionSeconds;
+  while (!m_segments.empty() && m_segments.begin()->first + DAY_SECONDS <= cutoff) {
+    RemoveSegment(m_segments.begin()->first);
+  }
+  m_purgedDay = now / DAY_SECONDS;
+}
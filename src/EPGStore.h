@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Models.h"
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class MappedFile;
+
+// EPG kept on disk in the addon profile, so after a restart only the days
+// not stored yet have to be fetched. One segment file per UTC day
+// ("<dayStart>.epg") holds blocks, each the complete EPG of one channel for
+// that day - every event overlapping the day, so it reads without its
+// neighbours.
+//
+// Segments are append-only: storing a channel's day again appends a new
+// block and the older one becomes garbage. Blocks follow the Snapshot
+// layout (native endianness, 8-byte aligned, one row of uint64 slots per
+// event in ModelFields::VisitEPGEvent order, strings as offset << 32 |
+// length into the block's string area), so a day is read straight out of an
+// mmap of its segment. Each block has its own checksum; a tail torn by a
+// crash mid-append is cut off by the next Open().
+//
+// Compaction is automatic: days that ended more than the retention ago are
+// deleted on Open() and on the first write of each new day, and a segment
+// made up mostly of superseded blocks is rewritten with just the live ones.
+class EPGStore {
+public:
+  static constexpr uint32_t VERSION = 2;
+  static constexpr time_t DAY_SECONDS = 24 * 60 * 60;
+  static constexpr const char* DIRECTORY_NAME = "epg";
+
+  EPGStore();
+  ~EPGStore();
+  EPGStore(const EPGStore&) = delete;
+  EPGStore& operator=(const EPGStore&) = delete;
+
+  // Indexes the segments in directory, creating it if needed. Segments
+  // written for another source (backend / EPG service) or format version
+  // are deleted.
+  bool Open(const std::string& directory, const std::string& source, int retentionDays);
+  void Close();
+  bool IsOpen() const;
+
+  // The channel's stored events for the day starting at dayStart, and how
+  // long ago they were written. Blocks maxAge or older are not returned, so
+  // a stored day is only as stale as a cached one may get.
+  bool Read(int channelUid, time_t dayStart, std::chrono::seconds maxAge, std::vector<EPGEvent>& events,
+            std::chrono::seconds& age);
+
+  // Stores events as the channel's complete EPG for every whole day in
+  // [start, end); partial days at either end are not stored.
+  void Write(int channelUid, time_t start, time_t end, const std::vector<EPGEvent>& events);
+
+  // Deletes every segment; the store stays open.
+  void Clear();
+
+private:
+  struct Block {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  struct Segment {
+    std::unordered_map<int, Block> blocks;  // latest block per channel
+    uint64_t size = 0;                      // bytes in the file
+    uint64_t liveBytes = 0;                 // file header plus latest blocks
+    std::unique_ptr<MappedFile> mapping;    // mapped on first read, dropped on append
+  };
+
+  std::string SegmentPath(time_t dayStart) const;
+  bool LoadSegment(time_t dayStart, Segment& segment);
+  bool Append(time_t dayStart, Segment& segment, int channelUid, const std::string& block);
+  bool Compact(time_t dayStart, Segment& segment);
+  void RemoveSegment(time_t dayStart);
+  void PurgeExpired(time_t now);
+
+  mutable std::mutex m_mutex;
+  std::string m_directory;  // empty while closed
+  uint64_t m_source = 0;
+  time_t m_retentionSeconds = 0;
+  time_t m_purgedDay = 0;
+  std::map<time_t, Segment> m_segments;
+};
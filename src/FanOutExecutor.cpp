@@ -0,0 +1,39 @@
+#include "FanOutExecutor.h"
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+
+void FanOutExecutor::Run(size_t count, const std::function<void(size_t)>& task) const {
+  if (count == 0) return;
+
+  size_t threads = std::min(count, static_cast<size_t>(std::max(1, m_maxConcurrency.load())));
+  if (threads == 1) {
+    for (size_t i = 0; i < count; ++i) task(i);
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  std::mutex errorMutex;
+  std::exception_ptr firstError;
+
+  auto worker = [&]() {
+    for (size_t i = next++; i < count; i = next++) {
+      try {
+        task(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!firstError) firstError = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> helpers;
+  helpers.reserve(threads - 1);
+  for (size_t t = 1; t < threads; ++t) helpers.emplace_back(worker);
+  worker();
+  for (auto& helper : helpers) helper.join();
+
+  if (firstError) std::rethrow_exception(firstError);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <functional>
+#include <atomic>
+#include <cstddef>
+
+// Runs a batch of independent tasks (the per-provider loads) on a bounded
+// number of threads and waits for all of them. Threads are created per Run()
+// call rather than pooled: batches are rare (startup, wake, timer changes)
+// and each task is a network round trip, so thread start-up cost is noise.
+class FanOutExecutor {
+public:
+  explicit FanOutExecutor(int maxConcurrency = 1) : m_maxConcurrency(maxConcurrency) {}
+
+  // Calls task(i) for every i in [0, count), at most GetMaxConcurrency() at
+  // a time; the calling thread takes part. Returns once all tasks finished.
+  // Completion order is unspecified - callers write results into per-index
+  // slots and merge them in index order afterwards. If a task throws, the
+  // remaining tasks still run and the first exception is rethrown here.
+  void Run(size_t count, const std::function<void(size_t)>& task) const;
+
+  void SetMaxConcurrency(int maxConcurrency) { m_maxConcurrency = maxConcurrency; }
+  int GetMaxConcurrency() const { return m_maxConcurrency.load(); }
+
+private:
+  std::atomic<int> m_maxConcurrency;
+};
@@ -0,0 +1,27 @@
+#include "HttpTransport.h"
+
+bool HttpTransport::Send(const HttpRequest& request, HttpResponse& response) {
+  std::unique_ptr<HttpBodyReader> reader = Open(request, response);
+  if (!reader) return false;
+
+  char buffer[16384];
+  long bytesRead;
+  while ((bytesRead = reader->Read(buffer, sizeof(buffer))) > 0) {
+    response.body.append(buffer, static_cast<size_t>(bytesRead));
+  }
+  return bytesRead == 0;
+}
+
+HttpBodyStreamBuf::int_type HttpBodyStreamBuf::underflow() {
+  if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+  if (m_failed) return traits_type::eof();
+
+  long bytesRead = m_reader.Read(m_buffer, sizeof(m_buffer));
+  if (bytesRead <= 0) {
+    m_failed = bytesRead < 0;
+    return traits_type::eof();
+  }
+  m_bytesRead += static_cast<size_t>(bytesRead);
+  setg(m_buffer, m_buffer, m_buffer + bytesRead);
+  return traits_type::to_int_type(*gptr());
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <utility>
+#include <streambuf>
+
+struct HttpRequest {
+  std::string method = "GET";
+  std::string url;
+  std::string body;
+  // Sent in order. Values are plain (not URL-encoded) - each transport
+  // applies whatever encoding its wire format needs.
+  std::vector<std::pair<std::string, std::string>> headers;
+};
+
+struct HttpResponse {
+  int status = 0;
+  std::string body;
+  // Header names are stored lower-cased. VfsHttpTransport only fills in the
+  // few headers callers use (see VfsHttpTransport::Open).
+  std::map<std::string, std::string> headers;
+};
+
+// Pull-style access to a response body as it arrives, so large payloads
+// (EPG) can be parsed without first being buffered in full.
+class HttpBodyReader {
+public:
+  virtual ~HttpBodyReader() = default;
+
+  // Bytes read into buffer, 0 at end of body, negative on error.
+  virtual long Read(char* buffer, size_t size) = 0;
+};
+
+// std::streambuf over an HttpBodyReader, so a body can be handed to stream
+// parsers (nlohmann::json::sax_parse) as a std::istream without buffering it.
+class HttpBodyStreamBuf : public std::streambuf {
+public:
+  explicit HttpBodyStreamBuf(HttpBodyReader& reader) : m_reader(reader) {}
+
+  // True if the body ended with a read error rather than a clean end.
+  bool Failed() const { return m_failed; }
+  size_t BytesRead() const { return m_bytesRead; }
+
+protected:
+  int_type underflow() override;
+
+private:
+  HttpBodyReader& m_reader;
+  char m_buffer[16384];
+  bool m_failed = false;
+  size_t m_bytesRead = 0;
+};
+
+// Transport abstraction behind CPVRUltimate::HttpSendRequest. Open()/Send()
+// succeed only for a response the caller can use (2xx); connection errors
+// and HTTP error statuses both fail, matching the old CFile::OpenFile
+// behaviour that every caller is written against. response.status is filled
+// in whenever the server answered at all.
+class HttpTransport {
+public:
+  virtual ~HttpTransport() = default;
+
+  // Sends the request and reads the status line and headers. The body is
+  // left unread in the returned reader; response.body stays empty.
+  virtual std::unique_ptr<HttpBodyReader> Open(const HttpRequest& request, HttpResponse& response) = 0;
+  virtual const char* Name() const = 0;
+
+  // Open() plus reading the whole body into response.body.
+  bool Send(const HttpRequest& request, HttpResponse& response);
+};
@@ -0,0 +1,187 @@
+#include "InflatingHttpTransport.h"
+#include <kodi/General.h>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <zlib.h>
+
+namespace {
+
+enum class Coding { IDENTITY, GZIP, DEFLATE };
+
+Coding ParseContentEncoding(const HttpResponse& response) {
+  auto it = response.headers.find("content-encoding");
+  if (it == response.headers.end()) return Coding::IDENTITY;
+
+  std::string value;
+  for (char c : it->second) {
+    if (c != ' ' && c != '\t') value += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+  if (value == "gzip" || value == "x-gzip") return Coding::GZIP;
+  if (value == "deflate") return Coding::DEFLATE;
+  // identity, or a stacked/unknown coding we did not ask for - left as is.
+  return Coding::IDENTITY;
+}
+
+bool HasHeader(const HttpRequest& request, const char* name) {
+  return std::any_of(request.headers.begin(), request.headers.end(), [name](const auto& header) {
+    return header.first.size() == std::strlen(name) &&
+           std::equal(header.first.begin(), header.first.end(), name, [](char a, char b) {
+             return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+           });
+  });
+}
+
+}  // namespace
+
+// Pulls wire bytes from the inner reader and hands out decoded ones. The
+// first couple of bytes decide the mode: gzip magic or a zlib header means
+// inflate, a "deflate" body without a zlib header is taken as raw deflate
+// (a common server mistake), everything else is passed through.
+class InflatingHttpTransport::BodyReader : public HttpBodyReader {
+public:
+  BodyReader(InflatingHttpTransport& owner, std::unique_ptr<HttpBodyReader> inner, Coding coding)
+      : m_owner(owner), m_inner(std::move(inner)), m_coding(coding) {
+    std::memset(&m_stream, 0, sizeof(m_stream));
+    if (m_coding == Coding::IDENTITY) m_mode = Mode::PASSTHROUGH;
+  }
+
+  ~BodyReader() override {
+    if (m_mode == Mode::INFLATE) inflateEnd(&m_stream);
+  }
+
+  long Read(char* buffer, size_t size) override {
+    if (m_failed) return -1;
+    if (m_mode == Mode::UNDECIDED && !Start()) return Fail(nullptr);
+    if (size == 0) return 0;
+
+    if (m_mode == Mode::PASSTHROUGH) {
+      if (m_inPos < m_inLength) {
+        size_t n = std::min(size, m_inLength - m_inPos);
+        std::memcpy(buffer, m_in + m_inPos, n);
+        m_inPos += n;
+        m_owner.m_decodedBytes += n;
+        return static_cast<long>(n);
+      }
+      long rc = ReadWire(buffer, size);
+      if (rc > 0) m_owner.m_decodedBytes += static_cast<uint64_t>(rc);
+      return rc;
+    }
+    return Inflate(buffer, size);
+  }
+
+private:
+  enum class Mode { UNDECIDED, PASSTHROUGH, INFLATE };
+
+  long ReadWire(char* buffer, size_t size) {
+    if (m_innerEnded) return 0;
+    long rc = m_inner->Read(buffer, size);
+    if (rc > 0) m_owner.m_wireBytes += static_cast<uint64_t>(rc);
+    else if (rc == 0) m_innerEnded = true;
+    else m_failed = true;
+    return rc;
+  }
+
+  bool Start() {
+    while (m_inLength < 2 && !m_innerEnded) {
+      long rc = ReadWire(m_in + m_inLength, sizeof(m_in) - m_inLength);
+      if (rc < 0) return false;
+      m_inLength += static_cast<size_t>(rc);
+    }
+
+    const auto* bytes = reinterpret_cast<const unsigned char*>(m_in);
+    int windowBits = 0;
+    if (m_inLength >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) {
+      windowBits = 15 + 16;  // gzip wrapper
+    } else if (m_inLength >= 2 && (bytes[0] & 0x0f) == 8 && ((bytes[0] << 8) | bytes[1]) % 31 == 0) {
+      windowBits = 15;       // zlib wrapper (RFC 9110 "deflate")
+    } else if (m_coding == Coding::DEFLATE && m_inLength > 0) {
+      windowBits = -15;      // raw deflate
+    } else {
+      m_mode = Mode::PASSTHROUGH;
+      return true;
+    }
+
+    if (inflateInit2(&m_stream, windowBits) != Z_OK) return false;
+    m_mode = Mode::INFLATE;
+    m_stream.next_in = reinterpret_cast<Bytef*>(m_in);
+    m_stream.avail_in = static_cast<uInt>(m_inLength);
+    m_owner.m_compressedResponses++;
+    return true;
+  }
+
+  long Inflate(char* buffer, size_t size) {
+    m_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    m_stream.avail_out = static_cast<uInt>(std::min<size_t>(size, UINT_MAX));
+    const uInt outputSpace = m_stream.avail_out;
+
+    for (;;) {
+      if (m_streamEnded) {
+        // Anything after the end of the compressed stream is not body;
+        // it is still read off so a pooled connection can be reused.
+        char discard[4096];
+        while (ReadWire(discard, sizeof(discard)) > 0) {}
+        return 0;
+      }
+      if (m_stream.avail_in == 0) {
+        long rc = ReadWire(m_in, sizeof(m_in));
+        if (rc < 0) return Fail(nullptr);
+        if (rc == 0) return Fail("truncated compressed body");
+        m_stream.next_in = reinterpret_cast<Bytef*>(m_in);
+        m_stream.avail_in = static_cast<uInt>(rc);
+      }
+
+      int rc = inflate(&m_stream, Z_NO_FLUSH);
+      if (rc == Z_STREAM_END) {
+        m_streamEnded = true;
+      } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+        return Fail(m_stream.msg ? m_stream.msg : "inflate error");
+      }
+
+      size_t produced = outputSpace - m_stream.avail_out;
+      if (produced > 0) {
+        m_owner.m_decodedBytes += produced;
+        return static_cast<long>(produced);
+      }
+    }
+  }
+
+  long Fail(const char* reason) {
+    if (reason) kodi::Log(ADDON_LOG_ERROR, "Failed to decode compressed response: %s", reason);
+    m_failed = true;
+    return -1;
+  }
+
+  InflatingHttpTransport& m_owner;
+  std::unique_ptr<HttpBodyReader> m_inner;
+  Coding m_coding;
+  Mode m_mode = Mode::UNDECIDED;
+  z_stream m_stream;
+  char m_in[16384];
+  size_t m_inLength = 0;  // bytes in m_in read while sniffing
+  size_t m_inPos = 0;     // of those, already passed through
+  bool m_innerEnded = false;
+  bool m_streamEnded = false;
+  bool m_failed = false;
+};
+
+InflatingHttpTransport::InflatingHttpTransport(std::unique_ptr<HttpTransport> inner) : m_inner(std::move(inner)) {}
+
+std::unique_ptr<HttpBodyReader> InflatingHttpTransport::Open(const HttpRequest& request, HttpResponse& response) {
+  std::unique_ptr<HttpBodyReader> reader;
+  if (HasHeader(request, "Accept-Encoding")) {
+    reader = m_inner->Open(request, response);  // custom_headers already chose
+  } else {
+    HttpRequest encoded = request;
+    encoded.headers.emplace_back("Accept-Encoding", ACCEPT_ENCODING);
+    reader = m_inner->Open(encoded, response);
+  }
+  if (!reader) return nullptr;
+
+  m_responses++;
+  Coding coding = ParseContentEncoding(response);
+  // Callers see the decoded body, so the header no longer describes it.
+  if (coding != Coding::IDENTITY) response.headers.erase("content-encoding");
+  return std::make_unique<BodyReader>(*this, std::move(reader), coding);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "HttpTransport.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Decorator that advertises "Accept-Encoding: gzip, deflate" on every request
+// sent through the wrapped transport and inflates gzip/deflate bodies while
+// they are read, so callers (and the streaming EPG parser) only ever see the
+// decoded bytes. Wraps whichever transport is in use, pooled or VFS.
+//
+// A body is only inflated when it is actually compressed: Content-Encoding
+// must say so and a gzip body must start with the gzip magic. Anything else
+// (a layer below already decoded it, or the server ignored the header) is
+// passed through untouched, the same way ParseJsonResponse sniffs the wire
+// format instead of trusting Accept.
+class InflatingHttpTransport : public HttpTransport {
+public:
+  explicit InflatingHttpTransport(std::unique_ptr<HttpTransport> inner);
+
+  std::unique_ptr<HttpBodyReader> Open(const HttpRequest& request, HttpResponse& response) override;
+  const char* Name() const override { return m_inner->Name(); }
+
+  static constexpr const char* ACCEPT_ENCODING = "gzip, deflate";
+
+  // Totals over every body read so far. Wire bytes are what the server sent
+  // (compressed for inflated bodies); decoded bytes are what callers got.
+  uint64_t GetResponseCount() const { return m_responses.load(); }
+  uint64_t GetCompressedCount() const { return m_compressedResponses.load(); }
+  uint64_t GetWireBytes() const { return m_wireBytes.load(); }
+  uint64_t GetDecodedBytes() const { return m_decodedBytes.load(); }
+
+private:
+  class BodyReader;
+
+  std::unique_ptr<HttpTransport> m_inner;
+
+  std::atomic<uint64_t> m_responses{0};
+  std::atomic<uint64_t> m_compressedResponses{0};
+  std::atomic<uint64_t> m_wireBytes{0};
+  std::atomic<uint64_t> m_decodedBytes{0};
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Utils.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <ctime>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <nlohmann/json.hpp>
+
+// Compile-time tables describing which JSON members a model struct is decoded
+// from. nlohmann::json objects are std::maps, so their members come out
+// sorted by key; Decode() walks them once alongside the (constexpr-sorted)
+// table and assigns each member whose key is in the table and whose value has
+// the expected type. That replaces the per-field contains()/is_x()/
+// operator[]/get<>() chain - several tree lookups each - and strings are moved
+// out of the document rather than copied. Members that are missing, of the wrong type or
+// not in the table leave the target untouched, so defaults are whatever the
+// target held before Decode().
+//
+//   using F = JsonFieldTable::Fields<UltimateTimer>;
+//   static constexpr auto TIMER_FIELDS = JsonFieldTable::Sorted(std::array{
+//       F::String<&UltimateTimer::title>("title"), ...});
+//   JsonFieldTable::Decode(timerJson, TIMER_FIELDS, timer);
+class JsonFieldTable {
+public:
+  enum class Type { STRING, INTEGER, BOOLEAN };
+
+  template<typename Target>
+  struct Field {
+    std::string_view key;
+    Type type;
+    void (*assign)(nlohmann::json& value, Target& out);  // value is known to be of type
+  };
+
+  // Field makers. Member may be a member of a base class of Target, which
+  // lets a table decode into a struct that extends the model with members
+  // that only feed derived fields.
+  template<typename Target>
+  struct Fields {
+    template<auto Member>
+    static constexpr Field<Target> String(std::string_view key) {
+      return {key, Type::STRING, [](nlohmann::json& value, Target& out) {
+        out.*Member = std::move(value.get_ref<std::string&>());
+      }};
+    }
+    template<auto Member>
+    static constexpr Field<Target> Integer(std::string_view key) {
+      return {key, Type::INTEGER, [](nlohmann::json& value, Target& out) { out.*Member = value.get<int>(); }};
+    }
+    template<auto Member>
+    static constexpr Field<Target> Boolean(std::string_view key) {
+      return {key, Type::BOOLEAN, [](nlohmann::json& value, Target& out) { out.*Member = value.get<bool>(); }};
+    }
+    // ISO 8601 string, see Utils::ParseISO8601.
+    template<auto Member>
+    static constexpr Field<Target> Time(std::string_view key) {
+      return {key, Type::STRING, [](nlohmann::json& value, Target& out) {
+        out.*Member = Utils::ParseISO8601(value.get_ref<const std::string&>());
+      }};
+    }
+    static constexpr Field<Target> Custom(std::string_view key, Type type,
+                                          void (*assign)(nlohmann::json&, Target&)) {
+      return {key, type, assign};
+    }
+  };
+
+  // Orders a table for Decode()'s merge walk; use it to initialise the
+  // constexpr table so declaration order is free.
+  template<typename Target, size_t N>
+  static constexpr std::array<Field<Target>, N> Sorted(std::array<Field<Target>, N> fields) {
+    std::sort(fields.begin(), fields.end(),
+              [](const Field<Target>& a, const Field<Target>& b) { return a.key < b.key; });
+    return fields;
+  }
+
+  // object is taken by non-const reference because string members are moved
+  // out of it. A non-object leaves out untouched.
+  template<typename Target, size_t N>
+  static void Decode(nlohmann::json& object, const std::array<Field<Target>, N>& fields, Target& out) {
+    static_assert(std::is_same_v<nlohmann::json::object_t,
+                                 std::map<std::string, nlohmann::json, nlohmann::json::object_comparator_t>>,
+                  "Decode() relies on object members iterating in key order");
+    if (!object.is_object()) return;
+    auto field = fields.begin();
+    for (auto& [key, value] : object.get_ref<nlohmann::json::object_t&>()) {
+      while (field != fields.end() && field->key < key) ++field;
+      if (field == fields.end()) return;
+      if (field->key == key && Matches(field->type, value)) field->assign(value, out);
+    }
+  }
+
+private:
+  static bool Matches(Type type, const nlohmann::json& value) {
+    switch (type) {
+      case Type::STRING: return value.is_string();
+      case Type::INTEGER: return value.is_number_integer();
+      case Type::BOOLEAN: return value.is_boolean();
+    }
+    return false;
+  }
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// What one list request cost: filled in by the managers' Load* functions and
+// handed to an optional LoadStatsSink (the startup profiler). Reported once
+// per provider, or once with an empty provider for a request that is not
+// per-provider (the provider list itself).
+struct LoadStats {
+  using Clock = std::chrono::steady_clock;
+
+  std::string provider;
+  double wallMs = 0;        // request + parse + decode
+  uint64_t bytes = 0;       // response body size; 0 when not modified
+  size_t items = 0;         // entries decoded from the response
+  double parseMs = 0;       // parseJson + decoding into models
+  bool ok = false;
+  bool notModified = false;
+
+  static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+};
+
+// Called concurrently from the fan-out threads; must be thread-safe.
+using LoadStatsSink = std::function<void(const LoadStats&)>;
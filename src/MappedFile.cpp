@@ -0,0 +1,39 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return;
+  m_buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  m_data = reinterpret_cast<const uint8_t*>(m_buffer.data());
+  m_size = m_buffer.size();
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      m_data = static_cast<const uint8_t*>(mapped);
+      m_size = static_cast<size_t>(st.st_size);
+    }
+  }
+  close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Models.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+// Field lists of the list-dataset models and EPG events, for code that has
+// to walk every field of a record generically: the warm-start Snapshot and
+// EPGStore (de)serializers and the change-detection fingerprints. Each Visit* calls v(field) for every
+// field in a fixed order and works on const and non-const records alike.
+// Append new fields at the end (the snapshot layout follows this order).
+class ModelFields {
+public:
+  template <class P, class V> static void VisitProvider(P& p, V& v) {
+    v(p.name); v(p.label); v(p.country); v(p.logo); v(p.enabled); v(p.uniqueId);
+  }
+
+  template <class C, class V> static void VisitChannel(C& c, V& v) {
+    v(c.uniqueId); v(c.channelNumber); v(c.channelName); v(c.iconPath); v(c.provider); v(c.channelId);
+    v(c.isRadio); v(c.mode); v(c.sessionManifest); v(c.manifest); v(c.manifestScript); v(c.useCdm);
+    v(c.cdmMode); v(c.contentType); v(c.country); v(c.language); v(c.streamingFormat); v(c.catchupHours);
+  }
+
+  template <class T, class V> static void VisitTimerType(T& t, V& v) {
+    v(t.id); v(t.description); v(t.priority);
+  }
+
+  template <class R, class V> static void VisitRecording(R& r, V& v) {
+    v(r.uniqueId); v(r.title); v(r.provider); v(r.channelName); v(r.channelUid); v(r.isRadio);
+    v(r.startTime); v(r.endTime); v(r.durationSeconds); v(r.firstAired); v(r.seasonNumber);
+    v(r.episodeNumber); v(r.episodeName); v(r.seriesTitle); v(r.seriesId); v(r.plot); v(r.plotOutline);
+    v(r.genreDescription); v(r.genre); v(r.genreType); v(r.genreSubType); v(r.iconPath); v(r.thumbnailUrl);
+    v(r.fanartUrl); v(r.playCount); v(r.lastPlayedPosition); v(r.directory); v(r.sizeInBytes); v(r.priority);
+    v(r.lifetime); v(r.flags); v(r.clientProviderUid); v(r.providerName); v(r.epgEventId); v(r.status);
+    v(r.isDeleted); v(r.isPlayable); v(r.releaseYear);
+  }
+
+  template <class T, class V> static void VisitTimer(T& t, V& v) {
+    v(t.clientIndex); v(t.provider); v(t.timerTypeId); v(t.title); v(t.parentClientIndex);
+    v(t.clientChannelUid); v(t.channelName); v(t.startTime); v(t.endTime); v(t.startAnyTime);
+    v(t.endAnyTime); v(t.firstDay); v(t.marginStart); v(t.marginEnd); v(t.epgSearchString);
+    v(t.fullTextEpgSearch); v(t.epgUid); v(t.epgEventId); v(t.weekdays); v(t.preventDuplicateEpisodes);
+    v(t.seriesLink); v(t.directory); v(t.priority); v(t.lifetime); v(t.maxRecordings); v(t.recordingGroup);
+    v(t.genreType); v(t.genreSubType); v(t.state); v(t.description); v(t.lastUpdated);
+  }
+
+  template <class E, class V> static void VisitEPGEvent(E& e, V& v) {
+    v(e.start); v(e.end); v(e.title); v(e.plot); v(e.icon); v(e.episodeName); v(e.genre); v(e.hasGenre);
+    v(e.seasonNumber); v(e.episodeNumber);
+  }
+
+  // Content fingerprint of a record list: changes when any field of any
+  // record changes or records are added/removed, but not when the backend
+  // merely returns the same records in another order. An empty list is 0.
+  template <class T, class VisitFn> static uint64_t Fingerprint(const std::vector<T>& records, VisitFn visit) {
+    uint64_t fingerprint = 0;
+    for (const auto& record : records) {
+      RecordHasher hasher;
+      visit(record, hasher);
+      fingerprint += Mix(hasher.hash);
+    }
+    return fingerprint;
+  }
+
+private:
+  struct RecordHasher {
+    uint64_t hash = 14695981039346656037ull;  // FNV-1a
+
+    void Add(const void* data, size_t size) {
+      const auto* bytes = static_cast<const unsigned char*>(data);
+      for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+      }
+    }
+    void operator()(const std::string& value) {
+      uint64_t size = value.size();
+      Add(&size, sizeof(size));
+      Add(value.data(), value.size());
+    }
+    template <class N> void operator()(const N& value) {
+      static_assert(std::is_arithmetic_v<N>, "model fields must be strings or numbers");
+      int64_t widened = static_cast<int64_t>(value);
+      Add(&widened, sizeof(widened));
+    }
+  };
+
+  // splitmix64 finalizer, so summing record hashes does not cancel out.
+  static uint64_t Mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+  }
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 
 struct UltimateProvider {
   std::string name;
@@ -30,6 +31,23 @@ struct UltimateChannel {
   std::string country;
   std::string language;
   std::string streamingFormat;
+  int catchupHours = 0;
+};
+
+// Compact, Kodi-independent form of one EPG entry - what both the DOM and
+// the streaming EPG parsers produce before de-duplication, so the (much
+// larger) kodi::addon::PVREPGTag is only built for entries that are kept.
+struct EPGEvent {
+  uint64_t start = 0;
+  uint64_t end = 0;
+  std::string title;
+  std::string plot;
+  std::string icon;
+  std::string episodeName;
+  int genre = 0;
+  bool hasGenre = false;
+  int seasonNumber = 0;
+  int episodeNumber = 0;
 };
 
 struct DRMLicense {
@@ -49,12 +67,6 @@ struct DRMConfig {
   DRMLicense license;
 };
 
-struct ChannelLookupInfo {
-  std::string provider;
-  std::string channelId;
-  int catchupHours = 0;
-};
-
 struct UltimateRecording {
   std::string uniqueId;
   std::string title;
@@ -1,5 +1,10 @@
 #include "PVRUltimate.h"
 #include "Utils.h"
+#include "VfsHttpTransport.h"
+#include "PooledHttpTransport.h"
+#include "TaskGraph.h"
+#include "Snapshot.h"
+#include "StartupProfiler.h"
 #include <kodi/General.h>
 #include <kodi/AddonBase.h>
 #include <kodi/Filesystem.h>
@@ -9,6 +14,16 @@
 #include <thread>
 #include <chrono>
 
+// The snapshot and the startup profile are read/written with plain file I/O
+// (mmap, ofstream), so they need a native path.
+static std::string ProfileFilePath(const char* fileName) {
+  return kodi::vfs::TranslateSpecialProtocol(kodi::addon::GetUserPath(fileName));
+}
+
+// Kodi's default EPG range, prefetched at startup and kept in the EPG store.
+static constexpr int EPG_PAST_DAYS = 1;
+static constexpr int EPG_FUTURE_DAYS = 3;
+
 CPVRUltimate::CPVRUltimate()
     : m_backendUrl("127.0.0.1"),
       m_backendPort(7777),
@@ -41,6 +56,32 @@ CPVRUltimate::CPVRUltimate()
   m_maxRetries = kodi::addon::GetSettingInt("retry_attempts", 10);
   m_retryDelayMs = kodi::addon::GetSettingInt("retry_delay", 2000);
   m_useDatabaseEpg = kodi::addon::GetSettingBoolean("epg_enabled", false);
+  m_epgStreamingParse = kodi::addon::GetSettingBoolean("epg_streaming_parse", true);
+  m_epgManager->GetCache().SetTtl(std::chrono::minutes(std::max(0, kodi::addon::GetSettingInt("epg_cache_ttl", 180))));
+  m_wireFormat = static_cast<Utils::WireFormat>(
+      std::clamp(kodi::addon::GetSettingInt("wire_format", 1), 0, static_cast<int>(Utils::WireFormat::MSGPACK)));
+  m_warmStartSnapshot = kodi::addon::GetSettingBoolean("warm_start_snapshot", true);
+  m_epgStoreEnabled = kodi::addon::GetSettingBoolean("epg_store", true);
+
+  m_loadExecutor.SetMaxConcurrency(kodi::addon::GetSettingInt("provider_load_concurrency", 4));
+  m_epgPrefetchExecutor.SetMaxConcurrency(kodi::addon::GetSettingInt("epg_prefetch_concurrency", 4));
+  m_epgPrefetchLimiter.SetRate(std::max(0, kodi::addon::GetSettingInt("epg_prefetch_rate", 10)));
+  SetupRefreshJobs();
+
+  if (kodi::addon::GetSettingBoolean("connection_pool_enabled", true)) {
+    int poolSize = kodi::addon::GetSettingInt("connection_pool_size", 4);
+    m_transport = std::make_unique<PooledHttpTransport>(poolSize, std::make_unique<VfsHttpTransport>());
+    kodi::Log(ADDON_LOG_INFO, "HTTP transport: pooled keep-alive (%d connections per host)", poolSize);
+  } else {
+    m_transport = std::make_unique<VfsHttpTransport>();
+    kodi::Log(ADDON_LOG_INFO, "HTTP transport: Kodi VFS");
+  }
+  if (kodi::addon::GetSettingBoolean("http_compression", true)) {
+    auto inflating = std::make_unique<InflatingHttpTransport>(std::move(m_transport));
+    m_inflatingTransport = inflating.get();
+    m_transport = std::move(inflating);
+    kodi::Log(ADDON_LOG_INFO, "HTTP compression: Accept-Encoding %s", InflatingHttpTransport::ACCEPT_ENCODING);
+  }
 
   // Backend discovery and all initial data loading happen on a background
   // thread (see InitializeAsync) rather than here, so a slow or unreachable
@@ -53,18 +94,66 @@ CPVRUltimate::CPVRUltimate()
 
 CPVRUltimate::~CPVRUltimate() {
   kodi::Log(ADDON_LOG_INFO, "Ultimate PVR Client stopping...");
+  kodi::Log(ADDON_LOG_INFO, "EPG cache: %llu hits, %llu misses, %llu waits on an in-flight fetch",
+            static_cast<unsigned long long>(m_epgManager->GetCache().GetHitCount()),
+            static_cast<unsigned long long>(m_epgManager->GetCache().GetMissCount()),
+            static_cast<unsigned long long>(m_epgManager->GetInFlightWaitCount()));
   EnsureInitThreadStopped();
   if (m_initThread.joinable()) {
     m_initThread.join();
   }
+  m_refreshScheduler.Stop();  // in case init started it after EnsureInitThreadStopped stopped it
 }
 
 void CPVRUltimate::EnsureInitThreadStopped() {
   m_stopInit = true;
   m_initCv.notify_all();
+  m_refreshScheduler.Stop();
+
+  {
+    std::unique_lock<std::mutex> lock(m_initMutex);
+    m_initCv.wait_for(lock, std::chrono::seconds(15), [this]() { return !m_initRunning.load(); });
+  }
+  StopEpgPrefetch();
+}
+
+void CPVRUltimate::StartEpgPrefetch() {
+  std::lock_guard<std::mutex> lock(m_epgPrefetchMutex);
+  if (m_stopInit.load() || !m_epgManager->GetCache().IsEnabled()) return;
+  // A prefetch still running covers the previous channel list; the new one
+  // skips whatever it already cached.
+  m_stopEpgPrefetch = true;
+  if (m_epgPrefetchThread.joinable()) m_epgPrefetchThread.join();
+  m_stopEpgPrefetch = false;
+
+  m_epgPrefetchThread = std::thread([this]() {
+    auto cancelled = [this]() { return m_stopEpgPrefetch.load(); };
+    auto epgGet = [this, &cancelled](const std::string& endpoint) -> std::string {
+      if (!m_epgPrefetchLimiter.Acquire(cancelled)) return "";
+      return this->HttpGet(this->BuildApiUrl(endpoint), RequestClass::EPG);
+    };
+    auto epgServiceGet = [this, &cancelled](const std::string& endpoint) -> std::string {
+      if (!m_epgPrefetchLimiter.Acquire(cancelled)) return "";
+      return this->HttpGet(this->BuildEpgServiceUrl(endpoint), RequestClass::EPG);
+    };
+    auto parseJson = [](const std::string& response, nlohmann::json& doc) -> bool {
+      return Utils::ParseJsonResponse(response, doc);
+    };
+    auto channels = m_channelManager->GetData();
+    auto getChannelByUid = [&channels](int uid, ChannelView& channel) -> bool {
+      return ChannelManager::FindChannel(*channels, uid, channel);
+    };
+    const time_t now = std::time(nullptr);
+    m_epgManager->PrefetchEPG(channels->channels, now - EPG_PAST_DAYS * EPGStore::DAY_SECONDS,
+                              now + EPG_FUTURE_DAYS * EPGStore::DAY_SECONDS, epgGet, parseJson, getChannelByUid,
+                              epgServiceGet, m_useDatabaseEpg.load(), m_epgPrefetchExecutor, cancelled);
+  });
+}
 
-  std::unique_lock<std::mutex> lock(m_initMutex);
-  m_initCv.wait_for(lock, std::chrono::seconds(15), [this]() { return !m_initRunning.load(); });
+void CPVRUltimate::StopEpgPrefetch() {
+  std::lock_guard<std::mutex> lock(m_epgPrefetchMutex);
+  m_stopEpgPrefetch = true;
+  if (m_epgPrefetchThread.joinable()) m_epgPrefetchThread.join();
 }
 
 void CPVRUltimate::InitializeAsync() {
@@ -72,48 +161,151 @@ void CPVRUltimate::InitializeAsync() {
   m_initRunning = true;
   kodi::Log(ADDON_LOG_INFO, "Background initialization started...");
 
+  const auto initStart = std::chrono::steady_clock::now();
+  auto sinceStartMs = [initStart]() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - initStart).count();
+  };
+  // Phases and per-provider costs of this run, see the report at the end.
+  StartupProfiler profiler;
+
+  // Before Kodi can ask for EPG. Reopening on every run (wake, reconnect)
+  // indexes what is on disk now and drops days of another backend.
+  profiler.BeginPhase("epg_store");
+  OpenEpgStore();
+  profiler.EndPhase("epg_store");
+
+  // Only on a cold start: after OnSystemWake the managers still hold data at
+  // least as fresh as the snapshot.
+  bool restored = false;
+  if (m_warmStartSnapshot.load() && m_channelManager->GetChannelsAmount() == 0) {
+    profiler.BeginPhase("snapshot");
+    restored = RestoreSnapshot();
+    profiler.EndPhase("snapshot", restored);
+  }
+  if (restored) {
+    m_servingSnapshot = true;
+    for (size_t i = 0; i < static_cast<size_t>(Dataset::COUNT); ++i) SetReady(static_cast<Dataset>(i));
+    kodi::Log(ADDON_LOG_INFO, "Time to first channel list (snapshot): %lld ms",
+              static_cast<long long>(sinceStartMs()));
+    if (!m_stopInit.load()) PushChangedDatasets();
+  }
+
   try {
-    if (RetryBackendCall("initialization")) {
+    profiler.BeginPhase("probe");
+    bool backendReachable = RetryBackendCall("initialization");
+    profiler.EndPhase("probe", backendReachable);
+    if (backendReachable) {
       if (m_stopInit.load()) {
         m_initRunning = false;
         m_initCv.notify_all();
         return;
       }
 
+      profiler.BeginPhase("capabilities");
       DetectBackendCapabilities();
+      profiler.EndPhase("capabilities");
 
       auto httpGet = [this](const std::string& endpoint) -> std::string {
         return this->HttpGet(this->BuildApiUrl(endpoint));
       };
+      auto httpGetConditional = [this](const std::string& endpoint, bool conditional, bool& notModified) {
+        return this->HttpGetConditional(this->BuildApiUrl(endpoint), conditional, notModified);
+      };
       auto parseJson = [](const std::string& response, nlohmann::json& doc) -> bool {
         return Utils::ParseJsonResponse(response, doc);
       };
 
-      if (m_stopInit.load()) { m_initRunning = false; m_initCv.notify_all(); return; }
-      if (!m_providerManager->LoadProviders(httpGet, parseJson)) {
-        kodi::Log(ADDON_LOG_ERROR, "Failed to load providers");
-      }
-
-      const auto& providers = m_providerManager->GetProviders();
-
-      if (m_stopInit.load()) { m_initRunning = false; m_initCv.notify_all(); return; }
-      if (!m_channelManager->LoadChannels(providers, httpGet, parseJson)) {
-        kodi::Log(ADDON_LOG_ERROR, "Failed to load channels");
-      }
-
-      if (m_stopInit.load()) { m_initRunning = false; m_initCv.notify_all(); return; }
-      if (!m_timerManager->LoadTimerTypes(providers, httpGet, parseJson)) {
-        kodi::Log(ADDON_LOG_WARNING, "Failed to load timer types");
-      }
-
-      if (m_stopInit.load()) { m_initRunning = false; m_initCv.notify_all(); return; }
-      if (!m_recordingManager->LoadRecordings(providers, httpGet, parseJson)) {
-        kodi::Log(ADDON_LOG_WARNING, "Failed to load recordings or none available");
-      }
+      // Startup as a dependency graph: everything per-provider needs the
+      // provider list, nothing else depends on anything, so channels, timer
+      // types, recordings and timers all load side by side once providers
+      // are in. Each dataset is pushed to Kodi as soon as it is ready rather
+      // than after the slowest one (see the Trigger*Update note below), and
+      // only if it differs from what Kodi was last given (PushIfChanged).
+      // Each task marks its dataset ready before pushing it, so Kodi's
+      // re-fetch is answered with the data rather than by the IsReady() gate.
+      std::mutex changedMutex;
+      std::vector<std::string> changed;
+      auto notifyKodi = [this, &changedMutex, &changed](KodiDataset dataset) {
+        if (m_stopInit.load() || !PushIfChanged(dataset)) return;
+        std::lock_guard<std::mutex> lock(changedMutex);
+        changed.emplace_back(DatasetName(dataset));
+      };
 
+      TaskGraph startup;
+      TaskGraph::TaskId providersTask = startup.Add("providers", [&]() {
+        profiler.BeginPhase("providers");
+        bool loaded = m_providerManager->LoadProviders(httpGetConditional, parseJson, profiler.SinkFor("providers"));
+        profiler.EndPhase("providers", loaded);
+        if (!loaded) {
+          kodi::Log(ADDON_LOG_ERROR, "Failed to load providers");
+        }
+        SetReady(Dataset::PROVIDERS);
+        notifyKodi(KodiDataset::PROVIDERS);
+      });
+      TaskGraph::TaskId channelsTask = startup.Add("channels", [&]() {
+        profiler.BeginPhase("channels");
+        bool loaded = m_channelManager->LoadChannels(m_providerManager->GetData()->providers, httpGetConditional, parseJson,
+                                                     m_loadExecutor, profiler.SinkFor("channels"));
+        profiler.EndPhase("channels", loaded);
+        if (!loaded) {
+          kodi::Log(ADDON_LOG_ERROR, "Failed to load channels");
+        }
+        SetReady(Dataset::CHANNELS);
+        kodi::Log(ADDON_LOG_INFO, "Time to first channel list: %lld ms", static_cast<long long>(sinceStartMs()));
+        notifyKodi(KodiDataset::CHANNELS);
+      }, {providersTask});
+      // Runs in the background, so the remaining startup tasks and Kodi's
+      // first guide calls do not wait for the whole guide window.
+      startup.Add("epg prefetch", [&]() { StartEpgPrefetch(); }, {channelsTask});
+      TaskGraph::TaskId timerTypesTask = startup.Add("timer types", [&]() {
+        profiler.BeginPhase("timer_types");
+        bool loaded = m_timerManager->LoadTimerTypes(m_providerManager->GetData()->providers, httpGet, parseJson,
+                                                     m_loadExecutor, profiler.SinkFor("timer_types"));
+        profiler.EndPhase("timer_types", loaded);
+        if (!loaded) {
+          kodi::Log(ADDON_LOG_WARNING, "Failed to load timer types");
+        }
+        SetReady(Dataset::TIMER_TYPES);
+      }, {providersTask});
+      startup.Add("recordings", [&]() {
+        profiler.BeginPhase("recordings");
+        bool loaded = m_recordingManager->LoadRecordings(m_providerManager->GetData()->providers, httpGetConditional,
+                                                         parseJson, m_loadExecutor, profiler.SinkFor("recordings"));
+        profiler.EndPhase("recordings", loaded);
+        if (!loaded) {
+          kodi::Log(ADDON_LOG_WARNING, "Failed to load recordings or none available");
+        }
+        SetReady(Dataset::RECORDINGS);
+        notifyKodi(KodiDataset::RECORDINGS);
+      }, {providersTask});
+      TaskGraph::TaskId timersTask = startup.Add("timers", [&]() {
+        profiler.BeginPhase("timers");
+        bool loaded = m_timerManager->LoadTimers(m_providerManager->GetData()->providers, httpGetConditional, parseJson,
+                                                 m_loadExecutor, profiler.SinkFor("timers"));
+        profiler.EndPhase("timers", loaded);
+        if (!loaded) {
+          kodi::Log(ADDON_LOG_WARNING, "Failed to load timers or none available");
+        }
+        SetReady(Dataset::TIMERS);
+      }, {providersTask});
+      // Kodi re-reads timer types along with timers, so only announce timers
+      // once both are in.
+      startup.Add("timers ready", [&]() {
+        notifyKodi(KodiDataset::TIMERS);
+      }, {timerTypesTask, timersTask});
+
+      startup.Run([this]() { return m_stopInit.load(); });
+      kodi::Log(ADDON_LOG_INFO, "Startup tasks: %s", startup.Summary().c_str());
+      std::string changedList;
+      for (const auto& name : changed) changedList += (changedList.empty() ? "" : ", ") + name;
+      kodi::Log(ADDON_LOG_INFO, "Startup data changes pushed to Kodi: %s (%zu of %d datasets)",
+                changedList.empty() ? "none" : changedList.c_str(), changed.size(),
+                static_cast<int>(KodiDataset::COUNT));
       if (m_stopInit.load()) { m_initRunning = false; m_initCv.notify_all(); return; }
-      if (!m_timerManager->LoadTimers(providers, httpGet, parseJson)) {
-        kodi::Log(ADDON_LOG_WARNING, "Failed to load timers or none available");
+      if (m_warmStartSnapshot.load()) {
+        profiler.BeginPhase("snapshot_save");
+        SaveSnapshot();
+        profiler.EndPhase("snapshot_save");
       }
     } else {
       kodi::QueueNotification(QUEUE_WARNING, "PVR Ultimate", "Backend unavailable - check connection settings");
@@ -131,26 +323,224 @@ void CPVRUltimate::InitializeAsync() {
   int timerCount = m_timerManager->GetTimersAmount();
   kodi::Log(ADDON_LOG_INFO, "Ultimate PVR Client loaded %d channels, %d recordings, %d timers",
             channelCount, recordingCount, timerCount);
+  kodi::Log(ADDON_LOG_INFO, "Time to fully loaded: %lld ms", static_cast<long long>(sinceStartMs()));
+  profiler.Finish();
+  kodi::Log(ADDON_LOG_INFO, "Startup profile: %s", profiler.Summary().c_str());
+  kodi::vfs::CreateDirectory(kodi::addon::GetUserPath());
+  profiler.Save(ProfileFilePath(StartupProfiler::FILE_NAME), kodi::addon::GetAddonInfo("version"));
+  kodi::Log(ADDON_LOG_INFO, "HTTP GET single-flight: %llu executed, %llu coalesced (%llu bytes not re-fetched)",
+            static_cast<unsigned long long>(m_singleFlight.GetExecutedCount()),
+            static_cast<unsigned long long>(m_singleFlight.GetCoalescedCount()),
+            static_cast<unsigned long long>(m_singleFlight.GetCoalescedBytes()));
+  kodi::Log(ADDON_LOG_INFO, "HTTP conditional GET: %llu list responses not modified",
+            static_cast<unsigned long long>(m_notModifiedCount.load()));
+  if (m_inflatingTransport) {
+    uint64_t wireBytes = m_inflatingTransport->GetWireBytes();
+    uint64_t decodedBytes = m_inflatingTransport->GetDecodedBytes();
+    kodi::Log(ADDON_LOG_INFO,
+              "HTTP compression: %llu of %llu responses compressed, %llu bytes received for %llu decoded (%.0f%% saved)",
+              static_cast<unsigned long long>(m_inflatingTransport->GetCompressedCount()),
+              static_cast<unsigned long long>(m_inflatingTransport->GetResponseCount()),
+              static_cast<unsigned long long>(wireBytes), static_cast<unsigned long long>(decodedBytes),
+              decodedBytes ? 100.0 * (1.0 - static_cast<double>(wireBytes) / decodedBytes) : 0.0);
+  }
+  kodi::Log(ADDON_LOG_INFO, "Kodi dataset updates: %llu pushed, %llu skipped as unchanged",
+            static_cast<unsigned long long>(m_pushCount.load()),
+            static_cast<unsigned long long>(m_pushSkippedCount.load()));
 
-  m_initialized = true;
+  // Datasets whose task never ran (backend unreachable, cancelled graph)
+  // count as loaded-and-empty from here on.
+  for (size_t i = 0; i < static_cast<size_t>(Dataset::COUNT); ++i) SetReady(static_cast<Dataset>(i));
   m_initRunning = false;
   m_initCv.notify_all();
 
   // Kodi's initial PVR import runs concurrently with this background load
   // (that's the whole point of doing this off the constructor thread), so
-  // it will very likely call GetChannels()/GetProviders()/etc. before
-  // m_initialized flips true above, get an empty-but-successful result via
-  // IsReady() gating, and consider its initial import complete. Nothing
-  // else tells Kodi to re-check afterwards - these Trigger*Update() calls
-  // are what asks Kodi to re-fetch now that data actually exists. Skipped
-  // entirely if init was cancelled (stop/shutdown/OnSystemWake reload) so
-  // a torn-down instance doesn't fire callbacks into a dead PVR manager.
+  // it will very likely call GetChannels()/GetProviders()/etc. before the
+  // dataset is ready, get an empty-but-successful result via IsReady()
+  // gating, and consider its initial import complete. Nothing
+  // else tells Kodi to re-check afterwards - the Trigger*Update() calls
+  // fired by the startup tasks above are what asks Kodi to re-fetch now that
+  // data actually exists. This final pass catches anything those did not
+  // get to (the graph did not run, or a task threw); datasets already pushed
+  // are unchanged and skipped. Skipped entirely if init was cancelled
+  // (stop/shutdown/OnSystemWake reload) so a torn-down instance doesn't fire
+  // callbacks into a dead PVR manager.
   if (!m_stopInit.load()) {
-    TriggerChannelUpdate();
-    TriggerChannelGroupsUpdate();
-    TriggerProvidersUpdate();
-    TriggerRecordingUpdate();
-    TriggerTimerUpdate();
+    PushChangedDatasets();
+    m_refreshScheduler.Start();
+  }
+}
+
+const char* CPVRUltimate::DatasetName(KodiDataset dataset) {
+  switch (dataset) {
+    case KodiDataset::PROVIDERS: return "providers";
+    case KodiDataset::CHANNELS: return "channels";
+    case KodiDataset::RECORDINGS: return "recordings";
+    case KodiDataset::TIMERS: return "timers";
+    default: return "unknown";
+  }
+}
+
+bool CPVRUltimate::PushIfChanged(KodiDataset dataset) {
+  uint64_t fingerprint = 0;
+  switch (dataset) {
+    case KodiDataset::PROVIDERS: fingerprint = m_providerManager->GetFingerprint(); break;
+    case KodiDataset::CHANNELS: fingerprint = m_channelManager->GetFingerprint(); break;
+    case KodiDataset::RECORDINGS: fingerprint = m_recordingManager->GetFingerprint(); break;
+    case KodiDataset::TIMERS: fingerprint = m_timerManager->GetFingerprint(); break;
+    default: return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_pushMutex);
+    uint64_t& pushed = m_pushedFingerprints[static_cast<size_t>(dataset)];
+    if (pushed == fingerprint) {
+      m_pushSkippedCount++;
+      kodi::Log(ADDON_LOG_DEBUG, "Kodi update skipped, %s unchanged", DatasetName(dataset));
+      return false;
+    }
+    pushed = fingerprint;
+  }
+
+  switch (dataset) {
+    case KodiDataset::PROVIDERS: TriggerProvidersUpdate(); break;
+    case KodiDataset::CHANNELS:
+      TriggerChannelUpdate();
+      TriggerChannelGroupsUpdate();  // groups are derived from the channel list
+      break;
+    case KodiDataset::RECORDINGS: TriggerRecordingUpdate(); break;
+    case KodiDataset::TIMERS: TriggerTimerUpdate(); break;
+    default: break;
+  }
+  m_pushCount++;
+  return true;
+}
+
+static const char* const REFRESH_PROVIDERS = "providers";
+static const char* const REFRESH_CHANNELS = "channels";
+static const char* const REFRESH_RECORDINGS = "recordings";
+static const char* const REFRESH_TIMERS = "timers";
+static const char* const REFRESH_TIMER_TYPES = "timer types";
+
+// Refresh intervals are set in minutes, 0 disables the refresh.
+static int RefreshIntervalSeconds(const std::string& settingName, int defaultMinutes) {
+  return std::max(0, kodi::addon::GetSettingInt(settingName, defaultMinutes)) * 60;
+}
+
+void CPVRUltimate::SetupRefreshJobs() {
+  auto httpGet = [this](const std::string& endpoint) -> std::string {
+    return this->HttpGet(this->BuildApiUrl(endpoint));
+  };
+  auto httpGetConditional = [this](const std::string& endpoint, bool conditional, bool& notModified) {
+    return this->HttpGetConditional(this->BuildApiUrl(endpoint), conditional, notModified);
+  };
+  auto parseJson = [](const std::string& response, nlohmann::json& doc) -> bool {
+    return Utils::ParseJsonResponse(response, doc);
+  };
+
+  m_refreshScheduler.AddJob(REFRESH_PROVIDERS, RefreshIntervalSeconds("refresh_providers_interval", 60),
+                            [this, httpGetConditional, parseJson]() {
+    uint64_t before = m_providerManager->GetFingerprint();
+    if (!m_providerManager->LoadProviders(httpGetConditional, parseJson)) return;
+    // Also how a client whose backend was down at startup comes back.
+    m_backendAvailable = true;
+    // Channel numbers follow the provider list, so re-number right away.
+    if (m_providerManager->GetFingerprint() != before) m_refreshScheduler.RunSoon(REFRESH_CHANNELS);
+    OnRefreshed(KodiDataset::PROVIDERS);
+  });
+  m_refreshScheduler.AddJob(REFRESH_CHANNELS, RefreshIntervalSeconds("refresh_channels_interval", 60),
+                            [this, httpGetConditional, parseJson]() {
+    m_channelManager->LoadChannels(m_providerManager->GetData()->providers, httpGetConditional, parseJson, m_loadExecutor);
+    OnRefreshed(KodiDataset::CHANNELS);
+    // Moves the prefetched window along and covers new channels.
+    StartEpgPrefetch();
+  });
+  m_refreshScheduler.AddJob(REFRESH_RECORDINGS, RefreshIntervalSeconds("refresh_recordings_interval", 15),
+                            [this, httpGetConditional, parseJson]() {
+    m_recordingManager->LoadRecordings(m_providerManager->GetData()->providers, httpGetConditional, parseJson,
+                                       m_loadExecutor);
+    OnRefreshed(KodiDataset::RECORDINGS);
+  });
+  m_refreshScheduler.AddJob(REFRESH_TIMERS, RefreshIntervalSeconds("refresh_timers_interval", 5),
+                            [this, httpGetConditional, parseJson]() {
+    m_timerManager->LoadTimers(m_providerManager->GetData()->providers, httpGetConditional, parseJson, m_loadExecutor);
+    OnRefreshed(KodiDataset::TIMERS);
+  });
+  m_refreshScheduler.AddJob(REFRESH_TIMER_TYPES, RefreshIntervalSeconds("refresh_timer_types_interval", 240),
+                            [this, httpGet, parseJson]() {
+    m_timerManager->LoadTimerTypes(m_providerManager->GetData()->providers, httpGet, parseJson, m_loadExecutor);
+    OnRefreshed(KodiDataset::TIMERS);
+  });
+}
+
+void CPVRUltimate::OnRefreshed(KodiDataset dataset) {
+  if (m_refreshScheduler.StopRequested() || !PushIfChanged(dataset)) return;
+  kodi::Log(ADDON_LOG_INFO, "Background refresh: %s changed, Kodi updated", DatasetName(dataset));
+  if (m_warmStartSnapshot.load()) SaveSnapshot();
+}
+
+void CPVRUltimate::PushChangedDatasets() {
+  for (size_t i = 0; i < static_cast<size_t>(KodiDataset::COUNT); ++i) {
+    PushIfChanged(static_cast<KodiDataset>(i));
+  }
+}
+
+std::string CPVRUltimate::GetSnapshotSource() {
+  std::lock_guard<std::mutex> lock(m_configMutex);
+  return m_backendUrl + ":" + std::to_string(m_backendPort);
+}
+
+bool CPVRUltimate::RestoreSnapshot() {
+  Snapshot::Data data;
+  if (!Snapshot::Load(ProfileFilePath(Snapshot::FILE_NAME), data)) return false;
+  if (data.source != GetSnapshotSource() || data.providers.empty() || data.channels.empty()) {
+    kodi::Log(ADDON_LOG_INFO, "Snapshot: not usable for backend %s, ignoring", GetSnapshotSource().c_str());
+    return false;
+  }
+
+  kodi::Log(ADDON_LOG_INFO, "Snapshot: restored %zu providers, %zu channels, %zu recordings, %zu timers",
+            data.providers.size(), data.channels.size(), data.recordings.size(), data.timers.size());
+  m_providerManager->RestoreProviders(std::move(data.providers));
+  m_channelManager->RestoreChannels(data.channels);
+  m_recordingManager->RestoreRecordings(std::move(data.recordings));
+  m_timerManager->RestoreTimerTypes(std::move(data.timerTypes));
+  m_timerManager->RestoreTimers(std::move(data.timers));
+  return true;
+}
+
+void CPVRUltimate::OpenEpgStore() {
+  EPGStore& store = m_epgManager->GetStore();
+  if (!m_epgStoreEnabled.load() || !m_epgManager->GetCache().IsEnabled()) {
+    store.Close();
+    return;
+  }
+  std::string source = GetSnapshotSource();
+  if (m_useDatabaseEpg.load()) {
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    source += " " + m_epgServiceUrl;
+  }
+  store.Open(ProfileFilePath(EPGStore::DIRECTORY_NAME), source, EPG_PAST_DAYS);
+}
+
+void CPVRUltimate::SaveSnapshot() {
+  Snapshot::Data data;
+  data.source = GetSnapshotSource();
+
+  data.providers = m_providerManager->GetData()->providers;
+  auto channels = m_channelManager->GetData();
+  data.channels = channels->channels.ToChannels();
+  data.recordings = m_recordingManager->GetData()->recordings;
+  data.timerTypes = m_timerManager->GetTimerTypesData()->timerTypes;
+  data.timers = m_timerManager->GetTimersData()->timers;
+
+  // A failed load must not replace the last good snapshot with an empty one.
+  if (data.providers.empty() || data.channels.empty()) return;
+
+  kodi::vfs::CreateDirectory(kodi::addon::GetUserPath());
+  if (Snapshot::Save(ProfileFilePath(Snapshot::FILE_NAME), data)) {
+    kodi::Log(ADDON_LOG_DEBUG, "Snapshot: saved %zu channels, %zu recordings, %zu timers",
+              data.channels.size(), data.recordings.size(), data.timers.size());
   }
 }
 
@@ -183,19 +573,19 @@ void CPVRUltimate::DetectBackendCapabilities() {
   kodi::Log(ADDON_LOG_INFO, "Header piggyback enabled (hardcoded, backend confirmed supported)");
 }
 
-bool CPVRUltimate::RetryBackendCall(const std::string& operationName) {
+bool CPVRUltimate::RetryBackendCall(const std::string& operationName, RequestClass requestClass) {
   // HttpGet now retries internally (see HttpGet), so this no longer loops
   // itself - doing so would multiply attempts to maxRetries^2 and stack two
   // independent backoff delays on top of each other.
   std::string testUrl = BuildApiUrl("/api/providers");
-  std::string response = HttpGet(testUrl);
+  std::string response = HttpGet(testUrl, requestClass);
   if (!response.empty()) {
     kodi::Log(ADDON_LOG_INFO, "Backend connection established for %s", operationName.c_str());
     m_backendAvailable = true;
     return true;
   }
-  kodi::Log(ADDON_LOG_ERROR, "Backend unavailable for %s after %d attempts",
-            operationName.c_str(), m_maxRetries.load() + 1);
+  kodi::Log(ADDON_LOG_ERROR, "Backend unavailable for %s (%s retry budget exhausted)",
+            operationName.c_str(), RetryPolicy::ClassName(requestClass));
   m_backendAvailable = false;
   return false;
 }
@@ -232,9 +622,56 @@ ADDON_STATUS CPVRUltimate::SetSetting(const std::string& settingName,
   }
   else if (settingName == "epg_enabled") {
     m_useDatabaseEpg = settingValue.GetBoolean();
+    m_epgManager->GetCache().Clear();  // held EPG came from the other source
+    OpenEpgStore();
     kodi::Log(ADDON_LOG_INFO, "Database EPG service enabled: %s", m_useDatabaseEpg.load() ? "true" : "false");
     return ADDON_STATUS_OK;
   }
+  else if (settingName == "refresh_providers_interval" || settingName == "refresh_channels_interval" ||
+           settingName == "refresh_recordings_interval" || settingName == "refresh_timers_interval" ||
+           settingName == "refresh_timer_types_interval") {
+    static const std::map<std::string, const char*> jobs = {
+        {"refresh_providers_interval", REFRESH_PROVIDERS},
+        {"refresh_channels_interval", REFRESH_CHANNELS},
+        {"refresh_recordings_interval", REFRESH_RECORDINGS},
+        {"refresh_timers_interval", REFRESH_TIMERS},
+        {"refresh_timer_types_interval", REFRESH_TIMER_TYPES}};
+    int minutes = std::max(0, settingValue.GetInt());
+    m_refreshScheduler.SetInterval(jobs.at(settingName), minutes * 60);
+    kodi::Log(ADDON_LOG_INFO, "%s: %d min", settingName.c_str(), minutes);
+    return ADDON_STATUS_OK;
+  }
+  else if (settingName == "epg_store") {
+    m_epgStoreEnabled = settingValue.GetBoolean();
+    if (!m_epgStoreEnabled.load()) m_epgManager->GetStore().Clear();
+    OpenEpgStore();
+    kodi::Log(ADDON_LOG_INFO, "EPG store: %s", m_epgStoreEnabled.load() ? "true" : "false");
+    return ADDON_STATUS_OK;
+  }
+  else if (settingName == "warm_start_snapshot") {
+    m_warmStartSnapshot = settingValue.GetBoolean();
+    kodi::Log(ADDON_LOG_INFO, "Warm-start snapshot: %s", m_warmStartSnapshot.load() ? "true" : "false");
+    return ADDON_STATUS_OK;
+  }
+  else if (settingName == "wire_format") {
+    m_wireFormat = static_cast<Utils::WireFormat>(
+        std::clamp(settingValue.GetInt(), 0, static_cast<int>(Utils::WireFormat::MSGPACK)));
+    kodi::Log(ADDON_LOG_INFO, "Wire format: Accept %s", Utils::AcceptHeader(m_wireFormat.load()));
+    return ADDON_STATUS_OK;
+  }
+  else if (settingName == "epg_streaming_parse") {
+    m_epgStreamingParse = settingValue.GetBoolean();
+    kodi::Log(ADDON_LOG_INFO, "EPG streaming parse: %s", m_epgStreamingParse.load() ? "true" : "false");
+    return ADDON_STATUS_OK;
+  }
+  else if (settingName == "epg_cache_ttl") {
+    int minutes = std::max(0, settingValue.GetInt());
+    m_epgManager->GetCache().SetTtl(std::chrono::minutes(minutes));
+    if (minutes == 0) m_epgManager->GetCache().Clear();
+    OpenEpgStore();
+    kodi::Log(ADDON_LOG_INFO, "EPG cache TTL: %d min", minutes);
+    return ADDON_STATUS_OK;
+  }
   else if (settingName == "api_key") {
     std::lock_guard<std::mutex> lock(m_configMutex);
     m_apiKey = settingValue.GetString();
@@ -247,10 +684,34 @@ ADDON_STATUS CPVRUltimate::SetSetting(const std::string& settingName,
     kodi::Log(ADDON_LOG_INFO, "Custom headers changed");
     return ADDON_STATUS_NEED_RESTART;
   }
+  else if (settingName == "epg_prefetch_concurrency") {
+    m_epgPrefetchExecutor.SetMaxConcurrency(settingValue.GetInt());
+    kodi::Log(ADDON_LOG_INFO, "EPG prefetch concurrency changed to: %d", m_epgPrefetchExecutor.GetMaxConcurrency());
+    return ADDON_STATUS_OK;
+  }
+  else if (settingName == "epg_prefetch_rate") {
+    m_epgPrefetchLimiter.SetRate(std::max(0, settingValue.GetInt()));
+    kodi::Log(ADDON_LOG_INFO, "EPG prefetch rate changed to: %.0f req/s", m_epgPrefetchLimiter.GetRate());
+    return ADDON_STATUS_OK;
+  }
+  else if (settingName == "provider_load_concurrency") {
+    m_loadExecutor.SetMaxConcurrency(settingValue.GetInt());
+    kodi::Log(ADDON_LOG_INFO, "Provider load concurrency changed to: %d", m_loadExecutor.GetMaxConcurrency());
+    return ADDON_STATUS_OK;
+  }
+  else if (settingName == "connection_pool_enabled" || settingName == "connection_pool_size" ||
+           settingName == "http_compression") {
+    kodi::Log(ADDON_LOG_INFO, "HTTP transport setting %s changed", settingName.c_str());
+    return ADDON_STATUS_NEED_RESTART;
+  }
   else if (settingName == "epg_service_url") {
-    std::lock_guard<std::mutex> lock(m_configMutex);
-    m_epgServiceUrl = settingValue.GetString();
-    kodi::Log(ADDON_LOG_INFO, "EPG service URL changed to: %s", m_epgServiceUrl.c_str());
+    {
+      std::lock_guard<std::mutex> lock(m_configMutex);
+      m_epgServiceUrl = settingValue.GetString();
+      kodi::Log(ADDON_LOG_INFO, "EPG service URL changed to: %s", m_epgServiceUrl.c_str());
+    }
+    m_epgManager->GetCache().Clear();
+    OpenEpgStore();
     return ADDON_STATUS_OK;
   }
 
@@ -265,9 +726,17 @@ std::string CPVRUltimate::BuildApiUrl(const std::string& endpoint) {
   return url.str();
 }
 
-std::string CPVRUltimate::HttpSendRequest(const std::string& url, const std::string& method, const std::string& body) {
-  kodi::Log(ADDON_LOG_DEBUG, "HTTP %s: %s", method.c_str(), Utils::RedactUrl(url).c_str());
+std::string CPVRUltimate::BuildEpgServiceUrl(const std::string& endpoint) {
+  std::string baseUrl;
+  {
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    baseUrl = m_epgServiceUrl;
+  }
+  if (!baseUrl.empty() && baseUrl.back() == '/') baseUrl.pop_back();
+  return baseUrl + endpoint;
+}
 
+HttpRequest CPVRUltimate::BuildRequest(const std::string& url, const std::string& method, const std::string& body) {
   std::string apiKey, customHeaders;
   {
     std::lock_guard<std::mutex> lock(m_configMutex);
@@ -275,77 +744,211 @@ std::string CPVRUltimate::HttpSendRequest(const std::string& url, const std::str
     customHeaders = m_customHeaders;
   }
 
-  // 1. Basis-URL vorbereiten und den ersten Header mit '|' anhängen
-  std::string formattedUrl = url + "|Content-Type=application/json";
-
-  // 2. HTTP-Methode anhängen (falls nicht GET)
-  if (method != "GET") {
-    formattedUrl += "&customrequest=" + method;
-  }
-
-  // 3. Body anhängen (muss URL-encoded sein!)
-  if (!body.empty()) {
-    formattedUrl += "&postdata=" + Utils::UrlEncode(body);
-  }
+  HttpRequest request;
+  request.method = method;
+  request.url = url;
+  request.body = body;
+  request.headers.emplace_back("Content-Type", "application/json");
+  // Responses are parsed by format sniffing (Utils::ParseJsonResponse,
+  // EPGManager::ParseEPGStream), so whatever the backend picks is handled.
+  if (method == "GET") request.headers.emplace_back("Accept", Utils::AcceptHeader(m_wireFormat.load()));
 
-  // 4. Auth/custom headers - restored: these were dropped entirely by the
+  // Auth/custom headers - restored: these were dropped entirely by the
   // rapidjson migration (no Authorization header was ever sent, and
   // custom_headers was ignored), which would silently break any backend
   // that requires an API key.
   if (!apiKey.empty()) {
-    formattedUrl += "&Authorization=" + Utils::UrlEncode("Bearer " + apiKey);
+    request.headers.emplace_back("Authorization", "Bearer " + apiKey);
   }
   if (!customHeaders.empty()) {
     // The custom_headers setting predates this restore and may still be
     // entered in the pre-migration "|Header1=value1|Header2=value2" style
-    // (a leading '|' with '|'-separated pairs), rather than the
-    // '&'-separated style the rest of this URL now uses consistently.
-    // Normalize both to the '&'-separated form Kodi expects after the
-    // first '|' so either input format works.
+    // (a leading '|' with '|'-separated pairs), or in the '&'-separated
+    // Kodi URL-option style with URL-encoded values. Accept both and hand
+    // the transport plain name/value pairs.
     std::string normalized = customHeaders;
     if (!normalized.empty() && normalized.front() == '|') {
       normalized.erase(0, 1);
     }
     std::replace(normalized.begin(), normalized.end(), '|', '&');
-    if (!normalized.empty()) {
-      formattedUrl += "&" + normalized;
+    std::istringstream pairs(normalized);
+    std::string pair;
+    while (std::getline(pairs, pair, '&')) {
+      size_t eq = pair.find('=');
+      if (eq == std::string::npos || eq == 0) continue;
+      request.headers.emplace_back(pair.substr(0, eq), Utils::UrlDecode(pair.substr(eq + 1)));
     }
   }
 
-  kodi::vfs::CFile file;
+  return request;
+}
+
+std::string CPVRUltimate::HttpSendRequest(const std::string& url, const std::string& method, const std::string& body,
+                                          int* status) {
+  kodi::Log(ADDON_LOG_DEBUG, "HTTP %s: %s", method.c_str(), Utils::RedactUrl(url).c_str());
 
-  // 5. Datei/URL direkt öffnen (Kodi parst die Optionen automatisch heraus)
-  if (!file.OpenFile(formattedUrl, ADDON_READ_NO_CACHE)) {
-    kodi::Log(ADDON_LOG_ERROR, "Failed to open URL: %s", Utils::RedactUrl(url).c_str());
+  HttpRequest request = BuildRequest(url, method, body);
+  HttpResponse response;
+  bool ok = m_transport->Send(request, response);
+  if (status) *status = response.status;
+  if (!ok) {
+    kodi::Log(ADDON_LOG_ERROR, "Failed to open URL: %s (status %d)", Utils::RedactUrl(url).c_str(),
+              response.status);
     return "";
   }
+  return std::move(response.body);
+}
 
-  std::string content;
-  char buffer[16384]; // Increased from 1024 for better performance
-  ssize_t bytesRead;
-  while ((bytesRead = file.Read(buffer, sizeof(buffer))) > 0) {
-    content.append(buffer, bytesRead);
-  }
-  file.Close();
-  return content;
+std::string CPVRUltimate::HttpGet(const std::string& url, RequestClass requestClass) {
+  // Keyed by class as well as URL so a playback caller never ends up waiting
+  // on a background request's much longer retry budget.
+  std::string key = std::string(RetryPolicy::ClassName(requestClass)) + " " + url;
+  return m_singleFlight.Do(key, [this, &url, requestClass]() {
+    return HttpGetWithRetry(url, requestClass);
+  });
 }
 
-std::string CPVRUltimate::HttpGet(const std::string& url) {
-  // Restored per-request retry (dropped in the rapidjson migration - only
-  // RetryBackendCall's initial connectivity probe retried; every ordinary
-  // data load, including provider/channel/recording/timer loads, was a
-  // single-shot request with no retry at all).
-  int maxRetries = m_maxRetries.load();
-  int retryDelay = m_retryDelayMs.load();
+std::string CPVRUltimate::HttpGetWithRetry(const std::string& url, RequestClass requestClass) {
   std::string response;
-  for (int attempt = 0; attempt <= maxRetries; ++attempt) {
-    response = HttpSendRequest(url, "GET", "");
-    if (!response.empty()) return response;
-    if (attempt < maxRetries) {
-      SleepMs(retryDelay);
+  RunWithRetry(url, requestClass, [this, &url, &response](int& status) {
+    response = HttpSendRequest(url, "GET", "", &status);
+    return !response.empty();
+  });
+  return response;
+}
+
+std::string CPVRUltimate::HttpGetConditional(const std::string& url, bool conditional, bool& notModified) {
+  notModified = false;
+
+  HttpValidators validators;
+  if (conditional) {
+    std::lock_guard<std::mutex> lock(m_validatorMutex);
+    auto it = m_validators.find(url);
+    if (it != m_validators.end()) validators = it->second;
+  }
+
+  std::string body;
+  RunWithRetry(url, RequestClass::BACKGROUND, [this, &url, &validators, &body, &notModified](int& status) {
+    kodi::Log(ADDON_LOG_DEBUG, "HTTP GET (conditional): %s", Utils::RedactUrl(url).c_str());
+
+    HttpRequest request = BuildRequest(url, "GET", "");
+    if (!validators.etag.empty()) request.headers.emplace_back("If-None-Match", validators.etag);
+    if (!validators.lastModified.empty()) request.headers.emplace_back("If-Modified-Since", validators.lastModified);
+
+    HttpResponse response;
+    bool ok = m_transport->Send(request, response);
+    status = response.status;
+    if (response.status == 304 && (!validators.etag.empty() || !validators.lastModified.empty())) {
+      notModified = true;
+      return true;
+    }
+    if (!ok) {
+      kodi::Log(ADDON_LOG_ERROR, "Failed to open URL: %s (status %d)", Utils::RedactUrl(url).c_str(),
+                response.status);
+      return false;
+    }
+
+    // Delta-sync URLs (DeltaSync.h) carry a new cursor every time and are
+    // never requested again, so their validators would only pile up.
+    if (url.find("since=") != std::string::npos) {
+      body = std::move(response.body);
+      return !body.empty();
+    }
+
+    HttpValidators received;
+    auto etag = response.headers.find("etag");
+    if (etag != response.headers.end()) received.etag = etag->second;
+    auto lastModified = response.headers.find("last-modified");
+    if (lastModified != response.headers.end()) received.lastModified = lastModified->second;
+    {
+      std::lock_guard<std::mutex> lock(m_validatorMutex);
+      if (received.etag.empty() && received.lastModified.empty()) m_validators.erase(url);
+      else m_validators[url] = std::move(received);
     }
+
+    body = std::move(response.body);
+    return !body.empty();
+  });
+
+  if (notModified) {
+    m_notModifiedCount++;
+    kodi::Log(ADDON_LOG_DEBUG, "Not modified: %s", Utils::RedactUrl(url).c_str());
   }
-  return response;
+  return body;
+}
+
+bool CPVRUltimate::HttpGetStream(const std::string& url, RequestClass requestClass,
+                                 const std::function<bool(std::istream&)>& consumer) {
+  // Not coalesced through m_singleFlight: a body stream can only be consumed
+  // once. Callers needing that share the parsed result instead.
+  return RunWithRetry(url, requestClass, [this, &url, &consumer](int& status) {
+    kodi::Log(ADDON_LOG_DEBUG, "HTTP GET (stream): %s", Utils::RedactUrl(url).c_str());
+
+    HttpResponse response;
+    std::unique_ptr<HttpBodyReader> reader = m_transport->Open(BuildRequest(url, "GET", ""), response);
+    status = response.status;
+    if (!reader) {
+      kodi::Log(ADDON_LOG_ERROR, "Failed to open URL: %s (status %d)", Utils::RedactUrl(url).c_str(),
+                response.status);
+      return false;
+    }
+
+    HttpBodyStreamBuf buffer(*reader);
+    std::istream stream(&buffer);
+    if (consumer(stream)) return true;
+
+    // A connection dropped mid-body is worth retrying; a body that arrived
+    // intact but didn't parse is not.
+    if (buffer.Failed()) {
+      kodi::Log(ADDON_LOG_ERROR, "Read error after %zu bytes: %s", buffer.BytesRead(),
+                Utils::RedactUrl(url).c_str());
+      status = 0;
+    }
+    return false;
+  });
+}
+
+bool CPVRUltimate::RunWithRetry(const std::string& url, RequestClass requestClass,
+                                const std::function<bool(int& status)>& attempt) {
+  // Retries are bounded by both an attempt count and a wall-clock deadline
+  // from the caller's RetryPolicy, so e.g. a failing manifest fetch gives up
+  // after a few seconds instead of the ~20s the old fixed
+  // retry_attempts x retry_delay loop could take.
+  const RetryPolicy policy = RetryPolicy::For(requestClass, m_maxRetries.load(), m_retryDelayMs.load());
+  const std::string endpoint = CircuitBreaker::EndpointKey(url);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(policy.deadlineMs);
+
+  for (int attemptIndex = 0; attemptIndex < policy.maxAttempts; ++attemptIndex) {
+    if (!m_circuitBreaker.Allow(endpoint)) {
+      kodi::Log(ADDON_LOG_DEBUG, "Circuit open, not requesting %s", Utils::RedactUrl(url).c_str());
+      return false;
+    }
+
+    CircuitBreaker::Attempt outcome(m_circuitBreaker, endpoint);
+    int status = 0;
+    if (attempt(status)) {
+      outcome.Succeeded();
+      return true;
+    }
+    if (!RetryPolicy::IsRetryable(status)) {
+      // The backend answered (e.g. 404) - it is up, and asking again won't help.
+      outcome.Succeeded();
+      return false;
+    }
+    outcome.Failed();
+
+    if (attemptIndex + 1 >= policy.maxAttempts) break;
+    // Shutting down / reloading: background loads are being abandoned anyway.
+    if (requestClass == RequestClass::BACKGROUND && m_stopInit.load()) break;
+    int delayMs = policy.BackoffMs(attemptIndex);
+    if (std::chrono::steady_clock::now() + std::chrono::milliseconds(delayMs) >= deadline) {
+      kodi::Log(ADDON_LOG_DEBUG, "Retry deadline (%s, %d ms) reached for %s", RetryPolicy::ClassName(requestClass),
+                policy.deadlineMs, Utils::RedactUrl(url).c_str());
+      break;
+    }
+    SleepMs(delayMs);
+  }
+  return false;
 }
 
 bool CPVRUltimate::HttpDelete(const std::string& url) {
@@ -379,7 +982,8 @@ bool CPVRUltimate::HttpGetWithHeaders(const std::string& url,
                                        std::string& response,
                                        std::string& drmConfigsBase64,
                                        std::string& streamHeadersBase64) {
-  response = HttpGet(url);
+  // Only used to fetch stream manifests, i.e. always on a playback path.
+  response = HttpGet(url, RequestClass::PLAYBACK);
   if (response.empty()) return false;
 
   nlohmann::json doc;
@@ -403,7 +1007,8 @@ DRMConfig CPVRUltimate::GetDRMConfig(const std::string& provider, const std::str
                                      bool isRecording) {
   DRMConfig config;
   std::string entityPath = isRecording ? "/recordings/" : "/channels/";
-  std::string response = HttpGet(BuildApiUrl("/api/providers/" + Utils::UrlPathEncode(provider) + entityPath + Utils::UrlPathEncode(channelId) + "/drm"));
+  std::string response = HttpGet(BuildApiUrl("/api/providers/" + Utils::UrlPathEncode(provider) + entityPath + Utils::UrlPathEncode(channelId) + "/drm"),
+                                 RequestClass::PLAYBACK);
   if (response.empty()) return config;
 
   nlohmann::json document;
@@ -454,7 +1059,8 @@ nlohmann::json CPVRUltimate::GetDRMConfigJson(const std::string& provider, const
                                               bool isRecording) {
   nlohmann::json drmConfigs = nlohmann::json::object();
   std::string entityPath = isRecording ? "/recordings/" : "/channels/";
-  std::string response = HttpGet(BuildApiUrl("/api/providers/" + Utils::UrlPathEncode(provider) + entityPath + Utils::UrlPathEncode(channelId) + "/drm"));
+  std::string response = HttpGet(BuildApiUrl("/api/providers/" + Utils::UrlPathEncode(provider) + entityPath + Utils::UrlPathEncode(channelId) + "/drm"),
+                                 RequestClass::PLAYBACK);
   if (response.empty()) return drmConfigs;
 
   nlohmann::json document;
@@ -564,8 +1170,15 @@ PVR_ERROR CPVRUltimate::OnSystemWake() {
   if (m_initThread.joinable()) {
     m_initThread.join();
   }
+  m_refreshScheduler.Stop();  // restarted by the reload below
+
+  // Failures recorded before sleep say nothing about the network after wake.
+  m_circuitBreaker.Reset();
+  // Cache expiry runs on the steady clock, which stood still while asleep.
+  m_epgManager->GetCache().Clear();
 
-  m_initialized = false;
+  // Datasets stay ready: Kodi keeps being served the pre-sleep data while
+  // the reload runs, and only what the reload changes is pushed.
   m_initThread = std::thread(&CPVRUltimate::InitializeAsync, this);
 
   return PVR_ERROR_NO_ERROR;
@@ -576,13 +1189,13 @@ PVR_ERROR CPVRUltimate::OnSystemWake() {
 // ============================================================================
 
 PVR_ERROR CPVRUltimate::GetProvidersAmount(int& amount) {
-  if (!IsReady()) { amount = 0; return PVR_ERROR_NO_ERROR; }
+  if (!IsReady(Dataset::PROVIDERS)) { amount = 0; return PVR_ERROR_NO_ERROR; }
   amount = m_providerManager->GetProvidersAmount();
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR CPVRUltimate::GetProviders(kodi::addon::PVRProvidersResultSet& results) {
-  if (!IsReady()) return PVR_ERROR_NO_ERROR;
+  if (!IsReady(Dataset::PROVIDERS)) return PVR_ERROR_NO_ERROR;
   m_providerManager->GetProviders(results);
   return PVR_ERROR_NO_ERROR;
 }
@@ -592,13 +1205,13 @@ PVR_ERROR CPVRUltimate::GetProviders(kodi::addon::PVRProvidersResultSet& results
 // ============================================================================
 
 PVR_ERROR CPVRUltimate::GetChannelsAmount(int& amount) {
-  if (!IsReady()) { amount = 0; return PVR_ERROR_NO_ERROR; }
+  if (!IsReady(Dataset::CHANNELS)) { amount = 0; return PVR_ERROR_NO_ERROR; }
   amount = m_channelManager->GetChannelsAmount();
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR CPVRUltimate::GetChannels(bool radio, kodi::addon::PVRChannelsResultSet& results) {
-  if (!IsReady()) return PVR_ERROR_NO_ERROR;
+  if (!IsReady(Dataset::CHANNELS)) return PVR_ERROR_NO_ERROR;
   m_channelManager->GetChannels(radio, results);
   return PVR_ERROR_NO_ERROR;
 }
@@ -616,21 +1229,27 @@ PVR_ERROR CPVRUltimate::GetChannelStreamProperties(
 
   std::string provider, channelId;
   bool useCdm = true;
-  UltimateChannel ultimateChannel;
 
-  if (!IsReady()) {
+  if (!IsReady(Dataset::CHANNELS)) {
     kodi::Log(ADDON_LOG_WARNING, "GetChannelStreamProperties called before ready");
     return PVR_ERROR_SERVER_ERROR;
   }
 
-  if (!m_channelManager->GetChannelByUid(channel.GetUniqueId(), ultimateChannel)) {
-    return PVR_ERROR_SERVER_ERROR;
+  // No background refresh competes with the stream setup's requests.
+  RefreshScheduler::PauseScope pauseRefresh(m_refreshScheduler);
+
+  {
+    auto channels = m_channelManager->GetData();
+    ChannelView ultimateChannel;
+    if (!ChannelManager::FindChannel(*channels, channel.GetUniqueId(), ultimateChannel)) {
+      return PVR_ERROR_SERVER_ERROR;
+    }
+    provider = ultimateChannel.Provider();
+    channelId = ultimateChannel.ChannelId();
+    useCdm = ultimateChannel.UseCdm();
   }
-  provider = ultimateChannel.provider;
-  channelId = ultimateChannel.channelId;
-  useCdm = ultimateChannel.useCdm;
 
-  if (!m_backendAvailable.load() && !RetryBackendCall("stream playback")) {
+  if (!m_backendAvailable.load() && !RetryBackendCall("stream playback", RequestClass::PLAYBACK)) {
     return PVR_ERROR_SERVER_ERROR;
   }
 
@@ -642,7 +1261,7 @@ PVR_ERROR CPVRUltimate::GetChannelStreamProperties(
       return PVR_ERROR_SERVER_ERROR;
     }
   } else {
-    response = HttpGet(manifestApiUrl);
+    response = HttpGet(manifestApiUrl, RequestClass::PLAYBACK);
     if (response.empty()) return PVR_ERROR_SERVER_ERROR;
   }
 
@@ -704,43 +1323,22 @@ void CPVRUltimate::ApplyStreamHeaders(std::vector<kodi::addon::PVRStreamProperty
 // ============================================================================
 
 PVR_ERROR CPVRUltimate::GetChannelGroupsAmount(int& amount) {
-  amount = 2;
+  if (!IsReady(Dataset::CHANNELS)) { amount = 0; return PVR_ERROR_NO_ERROR; }
+  amount = m_channelManager->GetChannelGroupsAmount();
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR CPVRUltimate::GetChannelGroups(bool radio, kodi::addon::PVRChannelGroupsResultSet& results) {
-  if (radio) {
-    kodi::addon::PVRChannelGroup radioGroup;
-    radioGroup.SetIsRadio(true);
-    radioGroup.SetGroupName("Radio Stations");
-    results.Add(radioGroup);
-  } else {
-    kodi::addon::PVRChannelGroup tvGroup;
-    tvGroup.SetIsRadio(false);
-    tvGroup.SetGroupName("TV Channels");
-    results.Add(tvGroup);
-  }
+  if (!IsReady(Dataset::CHANNELS)) return PVR_ERROR_NO_ERROR;
+  m_channelManager->GetChannelGroups(radio, results);
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR CPVRUltimate::GetChannelGroupMembers(
     const kodi::addon::PVRChannelGroup& group,
     kodi::addon::PVRChannelGroupMembersResultSet& results) {
-
-  bool isRadioGroup = group.GetIsRadio();
-  std::string groupName = group.GetGroupName();
-
-  const auto& channels = m_channelManager->GetChannels();
-
-  for (const auto& channel : channels) {
-    if (channel.isRadio == isRadioGroup) {
-      kodi::addon::PVRChannelGroupMember member;
-      member.SetGroupName(groupName);
-      member.SetChannelUniqueId(channel.channelNumber);
-      member.SetChannelNumber(channel.channelNumber);
-      results.Add(member);
-    }
-  }
+  if (!IsReady(Dataset::CHANNELS)) return PVR_ERROR_NO_ERROR;
+  m_channelManager->GetChannelGroupMembers(group.GetGroupName(), group.GetIsRadio(), results);
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -750,33 +1348,42 @@ PVR_ERROR CPVRUltimate::GetChannelGroupMembers(
 
 PVR_ERROR CPVRUltimate::GetEPGForChannel(int channelUid, time_t start, time_t end,
                                          kodi::addon::PVREPGTagsResultSet& results) {
-  if (!IsReady()) return PVR_ERROR_NO_ERROR;
+  if (!IsReady(Dataset::CHANNELS)) return PVR_ERROR_NO_ERROR;
 
   auto httpGet = [this](const std::string& endpoint) -> std::string {
-    return this->HttpGet(this->BuildApiUrl(endpoint));
+    return this->HttpGet(this->BuildApiUrl(endpoint), RequestClass::EPG);
   };
   auto parseJson = [](const std::string& response, nlohmann::json& doc) -> bool {
     return Utils::ParseJsonResponse(response, doc);
   };
-  auto getChannelByUid = [this](int uid, UltimateChannel& channel) -> bool {
-    return m_channelManager->GetChannelByUid(uid, channel);
+  auto channels = m_channelManager->GetData();
+  auto getChannelByUid = [&channels](int uid, ChannelView& channel) -> bool {
+    return ChannelManager::FindChannel(*channels, uid, channel);
   };
   // Builds a full URL against the EPG service host and performs the request directly,
   // bypassing BuildApiUrl (which always targets the backend). The endpoint passed in by
-  // EPGManager already includes any versioning prefix (e.g. "/api/v1/..."), so this lambda
-  // does no path-rewriting of its own - it only owns scheme+host.
+  // EPGManager already includes any versioning prefix (e.g. "/api/v1/..."), so
+  // BuildEpgServiceUrl does no path-rewriting of its own - it only owns scheme+host.
   auto httpGetAbsolute = [this](const std::string& endpoint) -> std::string {
-    std::string baseUrl;
-    {
-      std::lock_guard<std::mutex> lock(m_configMutex);
-      baseUrl = m_epgServiceUrl;
-    }
-    if (!baseUrl.empty() && baseUrl.back() == '/') baseUrl.pop_back();
-    return this->HttpGet(baseUrl + endpoint);
+    return this->HttpGet(this->BuildEpgServiceUrl(endpoint), RequestClass::EPG);
   };
 
+  // Streaming variants: the response is SAX-parsed as it arrives instead of
+  // being held in full as a string and then as a json DOM.
+  std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)> httpGetStream;
+  std::function<bool(const std::string&, const std::function<bool(std::istream&)>&)> httpGetAbsoluteStream;
+  if (m_epgStreamingParse) {
+    httpGetStream = [this](const std::string& endpoint, const std::function<bool(std::istream&)>& consumer) {
+      return this->HttpGetStream(this->BuildApiUrl(endpoint), RequestClass::EPG, consumer);
+    };
+    httpGetAbsoluteStream = [this](const std::string& endpoint, const std::function<bool(std::istream&)>& consumer) {
+      return this->HttpGetStream(this->BuildEpgServiceUrl(endpoint), RequestClass::EPG, consumer);
+    };
+  }
+
   m_epgManager->GetEPGForChannel(channelUid, start, end, httpGet, parseJson, getChannelByUid,
-                                 results, httpGetAbsolute, m_useDatabaseEpg.load());
+                                 results, httpGetAbsolute, m_useDatabaseEpg.load(),
+                                 httpGetStream, httpGetAbsoluteStream);
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -798,16 +1405,18 @@ PVR_ERROR CPVRUltimate::GetEPGTagStreamProperties(
     const kodi::addon::PVREPGTag& tag,
     std::vector<kodi::addon::PVRStreamProperty>& properties) {
 
-  if (!IsReady()) {
+  if (!IsReady(Dataset::CHANNELS)) {
     kodi::Log(ADDON_LOG_WARNING, "GetEPGTagStreamProperties called before ready");
     return PVR_ERROR_SERVER_ERROR;
   }
 
+  RefreshScheduler::PauseScope pauseRefresh(m_refreshScheduler);
+
   // Raw HttpGet - NOT wrapped with BuildApiUrl. getManifestUrl (below) already returns a
   // fully-qualified URL (same as the live channel path), so wrapping it again here would
   // double-prefix the scheme+host (e.g. "http://host:porthttp://host:port/api/...").
   auto httpGet = [this](const std::string& url) -> std::string {
-    return this->HttpGet(url);
+    return this->HttpGet(url, RequestClass::PLAYBACK);
   };
   auto parseJson = [](const std::string& response, nlohmann::json& doc) -> bool {
     return Utils::ParseJsonResponse(response, doc);
@@ -815,14 +1424,15 @@ PVR_ERROR CPVRUltimate::GetEPGTagStreamProperties(
   auto getChannelInfo = [this](int uid, std::string& provider, std::string& channelId, int& catchupHours) -> bool {
     return m_channelManager->GetChannelInfo(uid, provider, channelId, catchupHours);
   };
-  auto getChannelByUid = [this](int uid, UltimateChannel& channel) -> bool {
-    return m_channelManager->GetChannelByUid(uid, channel);
+  auto channels = m_channelManager->GetData();
+  auto getChannelByUid = [&channels](int uid, ChannelView& channel) -> bool {
+    return ChannelManager::FindChannel(*channels, uid, channel);
   };
   auto isBackendAvailable = [this]() -> bool {
     return m_backendAvailable.load();
   };
   auto retryBackendCall = [this](const std::string& op) -> bool {
-    return this->RetryBackendCall(op);
+    return this->RetryBackendCall(op, RequestClass::PLAYBACK);
   };
   auto getManifestUrl = [this](const std::string& provider, const std::string& channelId) -> std::string {
     return this->GetManifestUrl(provider, channelId);
@@ -845,9 +1455,10 @@ PVR_ERROR CPVRUltimate::GetEPGTagStreamProperties(
   // streamHeadersBase64 come from the manifest response when piggyback is supported, otherwise
   // ApplyDRMProperties falls back to a separate /drm lookup via useCdm.
   int channelUid = tag.GetUniqueChannelId();
-  UltimateChannel channel;
-  if (m_channelManager->GetChannelByUid(channelUid, channel)) {
-    ApplyDRMProperties(properties, channel.provider, channel.channelId, channel.useCdm, drmConfigsBase64);
+  ChannelView channel;
+  if (ChannelManager::FindChannel(*channels, channelUid, channel)) {
+    ApplyDRMProperties(properties, std::string(channel.Provider()), std::string(channel.ChannelId()),
+                       channel.UseCdm(), drmConfigsBase64);
   }
   ApplyStreamHeaders(properties, streamHeadersBase64);
 
@@ -859,19 +1470,19 @@ PVR_ERROR CPVRUltimate::GetEPGTagStreamProperties(
 // ============================================================================
 
 PVR_ERROR CPVRUltimate::GetRecordingsAmount(bool deleted, int& amount) {
-  if (!IsReady()) { amount = 0; return PVR_ERROR_NO_ERROR; }
+  if (!IsReady(Dataset::RECORDINGS)) { amount = 0; return PVR_ERROR_NO_ERROR; }
   amount = m_recordingManager->GetRecordingsAmount(deleted);
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR CPVRUltimate::GetRecordings(bool deleted, kodi::addon::PVRRecordingsResultSet& results) {
-  if (!IsReady()) return PVR_ERROR_NO_ERROR;
+  if (!IsReady(Dataset::RECORDINGS)) return PVR_ERROR_NO_ERROR;
   m_recordingManager->GetRecordings(deleted, results);
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR CPVRUltimate::DeleteRecording(const kodi::addon::PVRRecording& recording) {
-  if (!IsReady()) return PVR_ERROR_SERVER_ERROR;
+  if (!IsReady(Dataset::RECORDINGS)) return PVR_ERROR_SERVER_ERROR;
   std::string recordingId = recording.GetRecordingId();
 
   auto buildApiUrl = [this](const std::string& endpoint) -> std::string {
@@ -892,18 +1503,20 @@ PVR_ERROR CPVRUltimate::GetRecordingStreamProperties(
     const kodi::addon::PVRRecording& recording,
     std::vector<kodi::addon::PVRStreamProperty>& properties) {
 
-  if (!IsReady()) {
+  if (!IsReady(Dataset::RECORDINGS)) {
     kodi::Log(ADDON_LOG_WARNING, "GetRecordingStreamProperties called before ready");
     return PVR_ERROR_SERVER_ERROR;
   }
 
+  RefreshScheduler::PauseScope pauseRefresh(m_refreshScheduler);
+
   std::string recordingId = recording.GetRecordingId();
 
   auto buildApiUrl = [this](const std::string& endpoint) -> std::string {
     return this->BuildApiUrl(endpoint);
   };
   auto httpGet = [this](const std::string& url) -> std::string {
-    return this->HttpGet(url);
+    return this->HttpGet(url, RequestClass::PLAYBACK);
   };
   auto parseJson = [](const std::string& response, nlohmann::json& doc) -> bool {
     return Utils::ParseJsonResponse(response, doc);
@@ -930,7 +1543,8 @@ PVR_ERROR CPVRUltimate::GetRecordingStreamProperties(
   // piggybacked response does). Recordings are DRM-looked-up via the
   // /recordings/ endpoint (not /channels/) as a fallback only, since
   // rec->uniqueId is a recording id, not a channel id.
-  if (auto* rec = m_recordingManager->FindRecording(recordingId)) {
+  auto recordings = m_recordingManager->GetData();
+  if (const auto* rec = RecordingManager::FindRecording(*recordings, recordingId)) {
     ApplyDRMProperties(properties, rec->provider, rec->uniqueId, true, drmConfigsBase64, /*isRecording=*/true);
   }
   ApplyStreamHeaders(properties, streamHeadersBase64);
@@ -948,25 +1562,25 @@ PVR_ERROR CPVRUltimate::GetRecordingEdl(const kodi::addon::PVRRecording& recordi
 // ============================================================================
 
 PVR_ERROR CPVRUltimate::GetTimerTypes(std::vector<kodi::addon::PVRTimerType>& types) {
-  if (!IsReady()) return PVR_ERROR_NO_ERROR;
+  if (!IsReady(Dataset::TIMER_TYPES)) return PVR_ERROR_NO_ERROR;
   m_timerManager->GetTimerTypes(types);
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR CPVRUltimate::GetTimersAmount(int& amount) {
-  if (!IsReady()) { amount = 0; return PVR_ERROR_NO_ERROR; }
+  if (!IsReady(Dataset::TIMERS)) { amount = 0; return PVR_ERROR_NO_ERROR; }
   amount = m_timerManager->GetTimersAmount();
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR CPVRUltimate::GetTimers(kodi::addon::PVRTimersResultSet& results) {
-  if (!IsReady()) return PVR_ERROR_NO_ERROR;
+  if (!IsReady(Dataset::TIMERS)) return PVR_ERROR_NO_ERROR;
   m_timerManager->GetTimers(results);
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR CPVRUltimate::AddTimer(const kodi::addon::PVRTimer& timer) {
-  if (!IsReady()) return PVR_ERROR_SERVER_ERROR;
+  if (!IsReady(Dataset::TIMERS) || !IsReady(Dataset::CHANNELS)) return PVR_ERROR_SERVER_ERROR;
   auto buildApiUrl = [this](const std::string& endpoint) -> std::string {
     return this->BuildApiUrl(endpoint);
   };
@@ -974,18 +1588,22 @@ PVR_ERROR CPVRUltimate::AddTimer(const kodi::addon::PVRTimer& timer) {
     return this->HttpPost(url, body);
   };
   auto loadTimers = [this]() {
-    auto httpGet = [this](const std::string& endpoint) -> std::string {
-      return this->HttpGet(this->BuildApiUrl(endpoint));
+    auto httpGet = [this](const std::string& endpoint, bool conditional, bool& notModified) {
+      return this->HttpGetConditional(this->BuildApiUrl(endpoint), conditional, notModified);
     };
     auto parseJson = [](const std::string& response, nlohmann::json& doc) -> bool {
       return Utils::ParseJsonResponse(response, doc);
     };
-    const auto& providers = m_providerManager->GetProviders();
-    m_timerManager->LoadTimers(providers, httpGet, parseJson);
+    auto providers = m_providerManager->GetData();
+    m_timerManager->LoadTimers(providers->providers, httpGet, parseJson, m_loadExecutor);
   };
 
-  if (!m_timerManager->AddTimer(timer, m_providerManager->GetProviders(),
-                                m_channelManager->GetLookup(),
+  auto providers = m_providerManager->GetData();
+  auto channels = m_channelManager->GetData();
+  auto getChannelByUid = [&channels](int uid, ChannelView& channel) -> bool {
+    return ChannelManager::FindChannel(*channels, uid, channel);
+  };
+  if (!m_timerManager->AddTimer(timer, providers->providers, getChannelByUid,
                                 buildApiUrl, httpPost, loadTimers)) {
     return PVR_ERROR_SERVER_ERROR;
   }
@@ -994,7 +1612,7 @@ PVR_ERROR CPVRUltimate::AddTimer(const kodi::addon::PVRTimer& timer) {
 }
 
 PVR_ERROR CPVRUltimate::DeleteTimer(const kodi::addon::PVRTimer& timer, bool forceDelete) {
-  if (!IsReady()) return PVR_ERROR_SERVER_ERROR;
+  if (!IsReady(Dataset::TIMERS)) return PVR_ERROR_SERVER_ERROR;
   int clientIndex = timer.GetClientIndex();
 
   auto buildApiUrl = [this](const std::string& endpoint) -> std::string {
@@ -1004,14 +1622,14 @@ PVR_ERROR CPVRUltimate::DeleteTimer(const kodi::addon::PVRTimer& timer, bool for
     return this->HttpDelete(url);
   };
   auto loadTimers = [this]() {
-    auto httpGet = [this](const std::string& endpoint) -> std::string {
-      return this->HttpGet(this->BuildApiUrl(endpoint));
+    auto httpGet = [this](const std::string& endpoint, bool conditional, bool& notModified) {
+      return this->HttpGetConditional(this->BuildApiUrl(endpoint), conditional, notModified);
     };
     auto parseJson = [](const std::string& response, nlohmann::json& doc) -> bool {
       return Utils::ParseJsonResponse(response, doc);
     };
-    const auto& providers = m_providerManager->GetProviders();
-    m_timerManager->LoadTimers(providers, httpGet, parseJson);
+    auto providers = m_providerManager->GetData();
+    m_timerManager->LoadTimers(providers->providers, httpGet, parseJson, m_loadExecutor);
   };
 
   if (!m_timerManager->DeleteTimer(clientIndex, forceDelete, buildApiUrl, httpDelete, loadTimers)) {
@@ -1022,7 +1640,7 @@ PVR_ERROR CPVRUltimate::DeleteTimer(const kodi::addon::PVRTimer& timer, bool for
 }
 
 PVR_ERROR CPVRUltimate::UpdateTimer(const kodi::addon::PVRTimer& timer) {
-  if (!IsReady()) return PVR_ERROR_SERVER_ERROR;
+  if (!IsReady(Dataset::TIMERS)) return PVR_ERROR_SERVER_ERROR;
   auto buildApiUrl = [this](const std::string& endpoint) -> std::string {
     return this->BuildApiUrl(endpoint);
   };
@@ -1030,14 +1648,14 @@ PVR_ERROR CPVRUltimate::UpdateTimer(const kodi::addon::PVRTimer& timer) {
     return this->HttpPut(url, body);
   };
   auto loadTimers = [this]() {
-    auto httpGet = [this](const std::string& endpoint) -> std::string {
-      return this->HttpGet(this->BuildApiUrl(endpoint));
+    auto httpGet = [this](const std::string& endpoint, bool conditional, bool& notModified) {
+      return this->HttpGetConditional(this->BuildApiUrl(endpoint), conditional, notModified);
     };
     auto parseJson = [](const std::string& response, nlohmann::json& doc) -> bool {
       return Utils::ParseJsonResponse(response, doc);
     };
-    const auto& providers = m_providerManager->GetProviders();
-    m_timerManager->LoadTimers(providers, httpGet, parseJson);
+    auto providers = m_providerManager->GetData();
+    m_timerManager->LoadTimers(providers->providers, httpGet, parseJson, m_loadExecutor);
   };
 
   if (!m_timerManager->UpdateTimer(timer, buildApiUrl, httpPut, loadTimers)) {
@@ -7,7 +7,17 @@
 #include "EPGManager.h"
 #include "RecordingManager.h"
 #include "TimerManager.h"
+#include "HttpTransport.h"
+#include "InflatingHttpTransport.h"
+#include "RetryPolicy.h"
+#include "SingleFlight.h"
+#include "FanOutExecutor.h"
+#include "RateLimiter.h"
+#include "RefreshScheduler.h"
+#include "Utils.h"
 #include <memory>
+#include <map>
+#include <array>
 #include <atomic>
 #include <mutex>
 #include <thread>
@@ -94,29 +104,88 @@ private:
   std::atomic<int> m_retryDelayMs;
   std::atomic<bool> m_supportsPiggyback;
   std::atomic<bool> m_useModernDrm;
+  // Response encoding advertised in every GET's Accept header ("wire_format").
+  std::atomic<Utils::WireFormat> m_wireFormat{Utils::WireFormat::CBOR};
 
   // EPG service settings (database EPG service, optional alternative to backend API)
   // m_epgServiceUrl is guarded by m_configMutex, same as m_backendUrl.
   std::atomic<bool> m_useDatabaseEpg;
+  std::atomic<bool> m_epgStreamingParse{true};
   std::string m_epgServiceUrl;
 
   // Background initialization. Backend discovery + all initial data loads run
   // on m_initThread so a slow/unreachable backend cannot block Kodi's PVR
   // client construction (which has its own watchdog timeout and can mark the
-  // addon broken if Create() doesn't return promptly). m_initialized gates
-  // every public accessor below until the first load completes; the
-  // destructor signals m_stopInit and joins the thread so no callback fires
-  // into a partially-destroyed object.
+  // addon broken if Create() doesn't return promptly). The destructor
+  // signals m_stopInit and joins the thread so no callback fires into a
+  // partially-destroyed object.
   std::thread m_initThread;
   std::atomic<bool> m_stopInit{false};
   std::atomic<bool> m_initRunning{false};
-  std::atomic<bool> m_initialized{false};
   std::condition_variable m_initCv;
   std::mutex m_initMutex;
 
   void InitializeAsync();
   void EnsureInitThreadStopped();
-  bool IsReady() const { return m_initialized.load() && m_backendAvailable.load(); }
+
+  // Per-dataset readiness. A flag is set once its dataset has been loaded
+  // (or has failed to load) for the first time, or restored from the
+  // snapshot, and stays set - reloads swap data in place. Each Kodi entry
+  // point gates only on the dataset(s) it reads, so the channel list is
+  // served while recordings are still downloading.
+  enum class Dataset { PROVIDERS, CHANNELS, RECORDINGS, TIMERS, TIMER_TYPES, COUNT };
+  std::array<std::atomic<bool>, static_cast<size_t>(Dataset::COUNT)> m_ready{};
+  void SetReady(Dataset dataset) { m_ready[static_cast<size_t>(dataset)] = true; }
+  bool IsReady(Dataset dataset) const {
+    return m_ready[static_cast<size_t>(dataset)].load() && (m_backendAvailable.load() || m_servingSnapshot.load());
+  }
+
+  // Warm start (warm_start_snapshot setting). The list datasets of the last
+  // successful startup are saved to the profile directory and restored before
+  // the backend is even probed, so Kodi gets channels/recordings/timers
+  // straight away; the regular startup loads then reconcile them with the
+  // backend. m_servingSnapshot lets IsReady() serve that data while the
+  // backend is still unreachable.
+  std::atomic<bool> m_warmStartSnapshot{true};
+  std::atomic<bool> m_servingSnapshot{false};
+  bool RestoreSnapshot();
+  void SaveSnapshot();
+  std::string GetSnapshotSource();
+
+  // EPG store (epg_store setting): fetched EPG days kept in the profile
+  // directory, so a restart only downloads days it does not have. Needs the
+  // EPG cache; (re)opened for the current backend and EPG service.
+  std::atomic<bool> m_epgStoreEnabled{true};
+  void OpenEpgStore();
+
+  // EPG prefetch: after the channels are loaded, a background thread fills
+  // the EPG cache for the guide window, epg_prefetch_concurrency requests
+  // at a time and at most epg_prefetch_rate per second. Kodi's own EPG calls
+  // are not limited; one for a channel being prefetched waits for that fetch
+  // instead of repeating it. Restarted with every channel load, stopped with
+  // the init thread.
+  FanOutExecutor m_epgPrefetchExecutor;
+  RateLimiter m_epgPrefetchLimiter;
+  std::mutex m_epgPrefetchMutex;
+  std::thread m_epgPrefetchThread;
+  std::atomic<bool> m_stopEpgPrefetch{false};
+  void StartEpgPrefetch();
+  void StopEpgPrefetch();
+
+  // Change-detected Kodi updates. Every Trigger*Update makes Kodi re-fetch
+  // and re-diff a whole dataset, so PushIfChanged only fires it when the
+  // dataset's manager fingerprint differs from the one last pushed (timers
+  // cover timer types, channels cover channel groups). Pushed
+  // fingerprints start at 0, the fingerprint of an empty dataset - which is
+  // what Kodi holds before the first load.
+  enum class KodiDataset { PROVIDERS, CHANNELS, RECORDINGS, TIMERS, COUNT };
+  std::mutex m_pushMutex;
+  std::array<uint64_t, static_cast<size_t>(KodiDataset::COUNT)> m_pushedFingerprints{};
+  std::atomic<uint64_t> m_pushCount{0};
+  std::atomic<uint64_t> m_pushSkippedCount{0};
+  bool PushIfChanged(KodiDataset dataset);
+  void PushChangedDatasets();
+  static const char* DatasetName(KodiDataset dataset);
 
   // Managers
   std::unique_ptr<ProviderManager> m_providerManager;
@@ -125,8 +194,52 @@ private:
   std::unique_ptr<RecordingManager> m_recordingManager;
   std::unique_ptr<TimerManager> m_timerManager;
 
-  // HTTP methods
-  std::string HttpGet(const std::string& url);
+  // HTTP transport. Pooled keep-alive connections by default, with the
+  // Kodi VFS path as its fallback (or used alone when pooling is disabled).
+  // Built once in the constructor; pool settings need an addon restart.
+  std::unique_ptr<HttpTransport> m_transport;
+  // The gzip/deflate decorator at the top of m_transport when
+  // http_compression is on (owned by m_transport), for its byte counts.
+  InflatingHttpTransport* m_inflatingTransport = nullptr;
+
+  // Per-endpoint circuit breakers shared by every HttpGet caller, so a
+  // backend outage seen by one dataset short-circuits the others too.
+  CircuitBreaker m_circuitBreaker;
+
+  // Runs the managers' per-provider list loads in parallel
+  // (provider_load_concurrency setting).
+  FanOutExecutor m_loadExecutor;
+
+  // Concurrent HttpGets for the same URL and RequestClass share one request.
+  SingleFlight m_singleFlight;
+
+  // Validators from the last 200 response per URL, for HttpGetConditional.
+  struct HttpValidators {
+    std::string etag;
+    std::string lastModified;
+  };
+  std::mutex m_validatorMutex;
+  std::map<std::string, HttpValidators> m_validators;
+  std::atomic<uint64_t> m_notModifiedCount{0};
+
+  // HTTP methods. HttpGet retries according to the RetryPolicy for
+  // requestClass; the mutating methods are single-shot.
+  std::string HttpGet(const std::string& url, RequestClass requestClass = RequestClass::BACKGROUND);
+  std::string HttpGetWithRetry(const std::string& url, RequestClass requestClass);
+  // Conditional GET for list loads. With conditional set, the ETag /
+  // Last-Modified last seen for this URL are sent as If-None-Match /
+  // If-Modified-Since; a 304 then returns "" with notModified set and the
+  // caller keeps the data it already has. Callers pass conditional=false when
+  // they hold no data for the URL (first load, or the last response was
+  // unusable), so a 304 can never leave them empty-handed.
+  std::string HttpGetConditional(const std::string& url, bool conditional, bool& notModified);
+  // GET whose body is handed to consumer as a stream instead of a string.
+  // Retries (per requestClass) cover failures to open and connections
+  // dropped mid-body; a false return from consumer on an intact body is final.
+  bool HttpGetStream(const std::string& url, RequestClass requestClass,
+                     const std::function<bool(std::istream&)>& consumer);
+  bool RunWithRetry(const std::string& url, RequestClass requestClass,
+                    const std::function<bool(int& status)>& attempt);
 
   bool HttpGetWithHeaders(const std::string& url,
                           std::string& response,
@@ -138,15 +251,21 @@ private:
   bool HttpPost(const std::string& url, const std::string& body);
 
   bool HttpPut(const std::string& url, const std::string& body);
-  std::string HttpSendRequest(const std::string& url, const std::string& method, const std::string& body);
+  std::string HttpSendRequest(const std::string& url, const std::string& method, const std::string& body,
+                              int* status = nullptr);
+  HttpRequest BuildRequest(const std::string& url, const std::string& method, const std::string& body);
 
   // Core methods
-  bool RetryBackendCall(const std::string& operationName);
+  bool RetryBackendCall(const std::string& operationName,
+                        RequestClass requestClass = RequestClass::BACKGROUND);
 
   static void SleepMs(int milliseconds);
   void DetectInputstreamVersion();
   void DetectBackendCapabilities();
   std::string BuildApiUrl(const std::string& endpoint);
+  // Against the database EPG service host; endpoint carries its own version
+  // prefix.
+  std::string BuildEpgServiceUrl(const std::string& endpoint);
 
   // DRM methods
   DRMConfig GetDRMConfig(const std::string& provider, const std::string& channelId,
@@ -164,4 +283,14 @@ private:
   // the live channel path and the EPG catchup path so header-parsing logic exists in one place.
   static void ApplyStreamHeaders(std::vector<kodi::addon::PVRStreamProperty>& properties,
                                  const std::string& streamHeadersBase64);
+
+  // Background refresh of the list datasets (refresh_*_interval settings),
+  // started once InitializeAsync has finished and stopped by
+  // EnsureInitThreadStopped. Paused while a stream is being set up. A job's
+  // changes go to Kodi through PushIfChanged and into the warm-start
+  // snapshot. Declared last so it is destroyed - and its jobs joined -
+  // before anything they use.
+  void SetupRefreshJobs();
+  void OnRefreshed(KodiDataset dataset);
+  RefreshScheduler m_refreshScheduler;
 };
\ No newline at end of file
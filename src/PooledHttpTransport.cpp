@@ -0,0 +1,521 @@
+#include "PooledHttpTransport.h"
+#include "Utils.h"
+#include <kodi/General.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <optional>
+
+#ifdef _WIN32
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
+  using SocketHandle = SOCKET;
+  static const SocketHandle kInvalidSocket = INVALID_SOCKET;
+  #define ULTIMATE_CLOSE_SOCKET closesocket
+  #define ULTIMATE_POLL WSAPoll
+  #define ULTIMATE_SEND_FLAGS 0
+#else
+  #include <sys/types.h>
+  #include <sys/socket.h>
+  #include <netinet/in.h>
+  #include <netinet/tcp.h>
+  #include <netdb.h>
+  #include <poll.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <cerrno>
+  using SocketHandle = int;
+  static const SocketHandle kInvalidSocket = -1;
+  #define ULTIMATE_CLOSE_SOCKET ::close
+  #define ULTIMATE_POLL ::poll
+  #ifdef MSG_NOSIGNAL
+    #define ULTIMATE_SEND_FLAGS MSG_NOSIGNAL
+  #else
+    #define ULTIMATE_SEND_FLAGS 0
+  #endif
+#endif
+
+namespace {
+
+std::string ToLower(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return value;
+}
+
+std::string Trim(const std::string& value) {
+  size_t first = value.find_first_not_of(" \t");
+  if (first == std::string::npos) return "";
+  size_t last = value.find_last_not_of(" \t\r");
+  return value.substr(first, last - first + 1);
+}
+
+// Requests that may be sent a second time when it is unclear whether the
+// server got the first one. A repeated POST/PUT/DELETE could add or delete
+// a timer twice.
+bool IsIdempotent(const std::string& method) { return method == "GET" || method == "HEAD"; }
+
+bool SetBlocking(SocketHandle fd, bool blocking) {
+#ifdef _WIN32
+  u_long mode = blocking ? 0 : 1;
+  return ioctlsocket(fd, FIONBIO, &mode) == 0;
+#else
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0) return false;
+  flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+  return fcntl(fd, F_SETFL, flags) == 0;
+#endif
+}
+
+void SetIoTimeouts(SocketHandle fd, int timeoutMs) {
+#ifdef _WIN32
+  DWORD tv = static_cast<DWORD>(timeoutMs);
+#else
+  timeval tv{};
+  tv.tv_sec = timeoutMs / 1000;
+  tv.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+}
+
+}  // namespace
+
+// One TCP connection plus whatever bytes were read past the end of the last
+// response header block (the start of the body, or of a chunk).
+class PooledHttpTransport::Connection {
+public:
+  explicit Connection(SocketHandle fd) : m_lastUsed(std::chrono::steady_clock::now()), m_fd(fd) {}
+  ~Connection() { ULTIMATE_CLOSE_SOCKET(m_fd); }
+  Connection(const Connection&) = delete;
+  Connection& operator=(const Connection&) = delete;
+
+  static std::unique_ptr<Connection> Open(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 || !addresses) {
+      return nullptr;
+    }
+
+    std::unique_ptr<Connection> connection;
+    for (addrinfo* ai = addresses; ai && !connection; ai = ai->ai_next) {
+      SocketHandle fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (fd == kInvalidSocket) continue;
+
+      // Non-blocking connect so an unreachable host costs CONNECT_TIMEOUT_MS,
+      // not the OS default (which can be minutes).
+      bool connected = false;
+      if (SetBlocking(fd, false)) {
+        int rc = connect(fd, ai->ai_addr, static_cast<int>(ai->ai_addrlen));
+        if (rc == 0) {
+          connected = true;
+        } else {
+          pollfd pfd{};
+          pfd.fd = fd;
+          pfd.events = POLLOUT;
+          if (ULTIMATE_POLL(&pfd, 1, CONNECT_TIMEOUT_MS) == 1) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &len);
+            connected = (error == 0);
+          }
+        }
+      }
+      if (!connected || !SetBlocking(fd, true)) {
+        ULTIMATE_CLOSE_SOCKET(fd);
+        continue;
+      }
+
+      int noDelay = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+      int noSigPipe = 1;
+      setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+      SetIoTimeouts(fd, IO_TIMEOUT_MS);
+      connection = std::make_unique<Connection>(fd);
+    }
+    freeaddrinfo(addresses);
+    return connection;
+  }
+
+  // sent is how much of data went out, also when it fails part way.
+  bool WriteAll(const std::string& data, size_t& sent) {
+    sent = 0;
+    while (sent < data.size()) {
+      auto rc = send(m_fd, data.data() + sent, static_cast<int>(data.size() - sent), ULTIMATE_SEND_FLAGS);
+      if (rc <= 0) return false;
+      sent += static_cast<size_t>(rc);
+    }
+    return true;
+  }
+
+  // Appends to m_buffer. Returns bytes read, 0 on orderly close, <0 on error/timeout.
+  long Fill() {
+    char chunk[16384];
+    auto rc = recv(m_fd, chunk, static_cast<int>(sizeof(chunk)), 0);
+    if (rc > 0) m_buffer.append(chunk, static_cast<size_t>(rc));
+    return static_cast<long>(rc);
+  }
+
+  // Idle keep-alive connections that the server already closed become
+  // readable (EOF). Anything readable while idle means the connection is not
+  // in a state we can send a new request on.
+  bool LooksAlive() const {
+    pollfd pfd{};
+    pfd.fd = m_fd;
+    pfd.events = POLLIN;
+    return ULTIMATE_POLL(&pfd, 1, 0) == 0;
+  }
+
+  std::string m_buffer;
+  std::chrono::steady_clock::time_point m_lastUsed;
+
+private:
+  SocketHandle m_fd;
+};
+
+PooledHttpTransport::PooledHttpTransport(int maxIdlePerHost, std::unique_ptr<HttpTransport> fallback)
+    : m_fallback(std::move(fallback)),
+      m_maxIdlePerHost(static_cast<size_t>(std::max(1, maxIdlePerHost))) {
+#ifdef _WIN32
+  WSADATA wsaData;
+  WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+}
+
+PooledHttpTransport::~PooledHttpTransport() {
+  {
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    m_idle.clear();
+  }
+#ifdef _WIN32
+  WSACleanup();
+#endif
+}
+
+bool PooledHttpTransport::ParseUrl(const std::string& url, Endpoint& endpoint) {
+  static const std::string scheme = "http://";
+  if (url.compare(0, scheme.size(), scheme) != 0) return false;
+
+  size_t hostStart = scheme.size();
+  size_t pathStart = url.find_first_of("/?", hostStart);
+  std::string authority = url.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+  if (authority.empty() || authority.find('@') != std::string::npos) return false;
+
+  endpoint.target = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+  if (endpoint.target.front() == '?') endpoint.target.insert(0, "/");
+
+  // "[v6addr]:port", "host:port" or bare "host".
+  endpoint.port = 80;
+  if (authority.front() == '[') {
+    size_t close = authority.find(']');
+    if (close == std::string::npos) return false;
+    endpoint.host = authority.substr(1, close - 1);
+    if (close + 1 < authority.size() && authority[close + 1] == ':') {
+      endpoint.port = Utils::SafeStoi(authority.substr(close + 2), 0);
+    }
+  } else {
+    size_t colon = authority.rfind(':');
+    endpoint.host = authority.substr(0, colon);
+    if (colon != std::string::npos) endpoint.port = Utils::SafeStoi(authority.substr(colon + 1), 0);
+  }
+  return !endpoint.host.empty() && endpoint.port > 0 && endpoint.port <= 65535;
+}
+
+std::unique_ptr<PooledHttpTransport::Connection> PooledHttpTransport::Acquire(const Endpoint& endpoint, bool& reused) {
+  const std::string key = endpoint.host + ":" + std::to_string(endpoint.port);
+  const auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    auto& idle = m_idle[key];
+    while (!idle.empty()) {
+      std::unique_ptr<Connection> connection = std::move(idle.back());
+      idle.pop_back();
+      auto idleMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - connection->m_lastUsed).count();
+      if (idleMs < IDLE_TIMEOUT_MS && connection->LooksAlive()) {
+        reused = true;
+        return connection;
+      }
+    }
+  }
+  reused = false;
+  return Connection::Open(endpoint.host, endpoint.port);
+}
+
+void PooledHttpTransport::Release(const Endpoint& endpoint, std::unique_ptr<Connection> connection) {
+  connection->m_lastUsed = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(m_poolMutex);
+  auto& idle = m_idle[endpoint.host + ":" + std::to_string(endpoint.port)];
+  // Requests beyond the pool size still run concurrently on transient
+  // connections; the pool size only caps how many are kept open afterwards.
+  if (idle.size() < m_maxIdlePerHost) idle.push_back(std::move(connection));
+}
+
+// Streams one response body off a connection. The connection goes back to
+// the pool only if the body was read to its end and the server allows reuse;
+// a reader abandoned half-way closes it instead.
+class PooledHttpTransport::BodyReader : public HttpBodyReader {
+public:
+  BodyReader(PooledHttpTransport& owner, const Endpoint& endpoint, std::unique_ptr<Connection> connection,
+             Framing framing, size_t contentLength, bool keepAlive)
+      : m_owner(owner), m_endpoint(endpoint), m_connection(std::move(connection)),
+        m_framing(framing), m_remaining(contentLength), m_keepAlive(keepAlive) {
+    if (m_framing == Framing::NONE || (m_framing == Framing::CONTENT_LENGTH && m_remaining == 0)) Finish();
+  }
+
+  long Read(char* buffer, size_t size) override {
+    if (m_failed) return -1;
+    if (m_done) return 0;
+
+    switch (m_framing) {
+      case Framing::CONTENT_LENGTH:
+        return Consume(buffer, std::min(size, m_remaining));
+
+      case Framing::CHUNKED:
+        if (m_remaining == 0 && !NextChunk()) return m_failed ? -1 : 0;
+        return Consume(buffer, std::min(size, m_remaining));
+
+      case Framing::UNTIL_CLOSE: {
+        if (m_connection->m_buffer.empty()) {
+          long rc = m_connection->Fill();
+          if (rc == 0) { Finish(); return 0; }
+          if (rc < 0) return Fail();
+        }
+        size_t n = std::min(size, m_connection->m_buffer.size());
+        std::memcpy(buffer, m_connection->m_buffer.data(), n);
+        m_connection->m_buffer.erase(0, n);
+        return static_cast<long>(n);
+      }
+
+      case Framing::NONE:
+      default:
+        return 0;
+    }
+  }
+
+private:
+  // Copies up to want bytes of the current length-delimited span.
+  long Consume(char* buffer, size_t want) {
+    if (want == 0) return 0;
+    if (m_connection->m_buffer.empty() && m_connection->Fill() <= 0) return Fail();
+    size_t n = std::min(want, m_connection->m_buffer.size());
+    std::memcpy(buffer, m_connection->m_buffer.data(), n);
+    m_connection->m_buffer.erase(0, n);
+    m_remaining -= n;
+
+    if (m_remaining == 0) {
+      if (m_framing == Framing::CONTENT_LENGTH) {
+        Finish();
+      } else if (!ReadLine().has_value()) {  // CRLF after chunk data
+        return Fail();
+      }
+    }
+    return static_cast<long>(n);
+  }
+
+  // Reads the next chunk-size line; false at the last chunk (or on error).
+  bool NextChunk() {
+    auto line = ReadLine();
+    if (!line) { Fail(); return false; }
+    try {
+      m_remaining = std::stoul(*line, nullptr, 16);
+    } catch (...) {
+      Fail();
+      return false;
+    }
+    if (m_remaining > 0) return true;
+
+    // Last chunk: skip trailers up to the terminating empty line.
+    for (;;) {
+      auto trailer = ReadLine();
+      if (!trailer) { Fail(); return false; }
+      if (trailer->empty()) break;
+    }
+    Finish();
+    return false;
+  }
+
+  std::optional<std::string> ReadLine() {
+    size_t lineEnd;
+    while ((lineEnd = m_connection->m_buffer.find("\r\n")) == std::string::npos) {
+      if (m_connection->m_buffer.size() > 8192 || m_connection->Fill() <= 0) return std::nullopt;
+    }
+    std::string line = m_connection->m_buffer.substr(0, lineEnd);
+    m_connection->m_buffer.erase(0, lineEnd + 2);
+    return line;
+  }
+
+  void Finish() {
+    m_done = true;
+    if (m_keepAlive && m_framing != Framing::UNTIL_CLOSE && m_connection->m_buffer.empty()) {
+      m_owner.Release(m_endpoint, std::move(m_connection));
+    }
+  }
+
+  long Fail() {
+    m_failed = true;
+    return -1;
+  }
+
+  PooledHttpTransport& m_owner;
+  Endpoint m_endpoint;
+  std::unique_ptr<Connection> m_connection;
+  Framing m_framing;
+  size_t m_remaining;
+  bool m_keepAlive;
+  bool m_done = false;
+  bool m_failed = false;
+};
+
+PooledHttpTransport::Outcome PooledHttpTransport::Exchange(Connection& connection, const Endpoint& endpoint,
+                                                           bool reused, const HttpRequest& request,
+                                                           HttpResponse& response, bool& keepAlive,
+                                                           Framing& framing, size_t& contentLength) {
+  std::ostringstream head;
+  head << request.method << ' ' << endpoint.target << " HTTP/1.1\r\n"
+       << "Host: " << endpoint.host;
+  if (endpoint.port != 80) head << ':' << endpoint.port;
+  head << "\r\nConnection: keep-alive\r\n";
+  if (!request.body.empty() || (request.method != "GET" && request.method != "HEAD")) {
+    head << "Content-Length: " << request.body.size() << "\r\n";
+  }
+  for (const auto& header : request.headers) {
+    head << header.first << ": " << header.second << "\r\n";
+  }
+  head << "\r\n";
+
+  // Once any of the request went out, the server may act on it even though
+  // the connection then fails, so only idempotent requests are sent again.
+  const bool idempotent = IsIdempotent(request.method);
+  size_t sent = 0;
+  if (!connection.WriteAll(head.str() + request.body, sent)) {
+    return (reused && (sent == 0 || idempotent)) ? Outcome::RETRY_FRESH : Outcome::FAILED;
+  }
+
+  // Status line + headers. 1xx interim responses are skipped.
+  size_t headerEnd = std::string::npos;
+  std::string statusLine;
+  bool http11 = false;
+  for (;;) {
+    while ((headerEnd = connection.m_buffer.find("\r\n\r\n")) == std::string::npos) {
+      if (connection.m_buffer.size() > 65536) return Outcome::FAILED;
+      long rc = connection.Fill();
+      if (rc <= 0) {
+        return (reused && idempotent && connection.m_buffer.empty()) ? Outcome::RETRY_FRESH : Outcome::FAILED;
+      }
+    }
+
+    std::string headerBlock = connection.m_buffer.substr(0, headerEnd);
+    connection.m_buffer.erase(0, headerEnd + 4);
+
+    std::istringstream lines(headerBlock);
+    std::getline(lines, statusLine);
+    std::istringstream statusStream(statusLine);
+    std::string version;
+    statusStream >> version >> response.status;
+    if (statusStream.fail() || version.compare(0, 5, "HTTP/") != 0) return Outcome::FAILED;
+    http11 = (version != "HTTP/1.0");
+
+    response.headers.clear();
+    std::string line;
+    while (std::getline(lines, line)) {
+      size_t colon = line.find(':');
+      if (colon == std::string::npos) continue;
+      std::string name = ToLower(Trim(line.substr(0, colon)));
+      std::string value = Trim(line.substr(colon + 1));
+      auto it = response.headers.find(name);
+      if (it == response.headers.end()) response.headers.emplace(name, value);
+      else it->second += ", " + value;
+    }
+
+    if (response.status >= 200 || response.status < 100) break;
+  }
+
+  auto headerValue = [&response](const std::string& name) -> std::string {
+    auto it = response.headers.find(name);
+    return it == response.headers.end() ? "" : ToLower(it->second);
+  };
+  std::string connectionHeader = headerValue("connection");
+  keepAlive = http11 ? connectionHeader.find("close") == std::string::npos
+                     : connectionHeader.find("keep-alive") != std::string::npos;
+
+  contentLength = 0;
+  if (request.method == "HEAD" || response.status == 204 || response.status == 304) {
+    framing = Framing::NONE;
+  } else if (headerValue("transfer-encoding").find("chunked") != std::string::npos) {
+    framing = Framing::CHUNKED;
+  } else if (!headerValue("content-length").empty()) {
+    try {
+      contentLength = std::stoul(headerValue("content-length"));
+    } catch (...) {
+      return Outcome::FAILED;
+    }
+    framing = Framing::CONTENT_LENGTH;
+  } else {
+    // No framing: body runs to connection close, which also rules out reuse.
+    framing = Framing::UNTIL_CLOSE;
+    keepAlive = false;
+  }
+  return Outcome::OK;
+}
+
+std::unique_ptr<HttpBodyReader> PooledHttpTransport::Open(const HttpRequest& request, HttpResponse& response) {
+  Endpoint endpoint;
+  if (!ParseUrl(request.url, endpoint)) {
+    return m_fallback ? m_fallback->Open(request, response) : nullptr;
+  }
+
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    bool reused = false;
+    std::unique_ptr<Connection> connection = Acquire(endpoint, reused);
+    if (!connection) break;
+
+    response = HttpResponse();
+    bool keepAlive = false;
+    Framing framing = Framing::NONE;
+    size_t contentLength = 0;
+    Outcome outcome = Exchange(*connection, endpoint, reused, request, response, keepAlive,
+                               framing, contentLength);
+
+    if (outcome == Outcome::RETRY_FRESH) {
+      // Server closed the idle keep-alive connection between requests - the
+      // normal keep-alive race, not a backend failure. One retry on a new one.
+      continue;
+    }
+    if (outcome == Outcome::FAILED) {
+      kodi::Log(ADDON_LOG_DEBUG, "Pooled HTTP %s failed on %s connection: %s", request.method.c_str(),
+                reused ? "reused" : "new", Utils::RedactUrl(request.url).c_str());
+      return nullptr;
+    }
+
+    if (response.status >= 300 && response.status < 400 && response.status != 304 && m_fallback &&
+        IsIdempotent(request.method)) {
+      // Redirects are left to Kodi's curl, which follows them. 304 (a
+      // conditional GET's "not modified") has no body and is the caller's.
+      // Other methods are not sent again; the 3xx is returned as a failure.
+      response = HttpResponse();
+      return m_fallback->Open(request, response);
+    }
+
+    // Error bodies are still drained so the connection stays reusable.
+    auto reader = std::make_unique<BodyReader>(*this, endpoint, std::move(connection), framing,
+                                               contentLength, keepAlive);
+    if (response.status >= 200 && response.status < 300) return reader;
+
+    char discard[4096];
+    while (reader->Read(discard, sizeof(discard)) > 0) {}
+    return nullptr;
+  }
+
+  // Could not connect directly (or the fresh retry also failed) - Kodi's own
+  // transport may still get through, e.g. via a configured proxy.
+  kodi::Log(ADDON_LOG_DEBUG, "Pooled HTTP connect to %s:%d failed, using fallback transport",
+            endpoint.host.c_str(), endpoint.port);
+  response = HttpResponse();
+  return m_fallback ? m_fallback->Open(request, response) : nullptr;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "HttpTransport.h"
+#include <memory>
+#include <mutex>
+#include <map>
+#include <vector>
+#include <string>
+
+// Plain-HTTP/1.1 transport that keeps connections to each host:port open
+// between requests, so channel zaps, EPG pages and timer mutations don't pay
+// for a new TCP handshake each time. Only http:// URLs are handled directly
+// (the backend is always addressed that way, see CPVRUltimate::BuildApiUrl);
+// https, redirects and hosts we cannot connect to are handed to the fallback
+// transport (normally VfsHttpTransport), which also keeps Kodi's proxy
+// settings in play for those.
+class PooledHttpTransport : public HttpTransport {
+public:
+  PooledHttpTransport(int maxIdlePerHost, std::unique_ptr<HttpTransport> fallback);
+  ~PooledHttpTransport() override;
+
+  std::unique_ptr<HttpBodyReader> Open(const HttpRequest& request, HttpResponse& response) override;
+  const char* Name() const override { return "pooled"; }
+
+  static constexpr int CONNECT_TIMEOUT_MS = 5000;
+  static constexpr int IO_TIMEOUT_MS = 30000;
+  static constexpr int IDLE_TIMEOUT_MS = 30000;
+
+private:
+  struct Endpoint {
+    std::string host;
+    int port = 80;
+    std::string target;  // path + query, always starts with '/'
+  };
+  class Connection;
+  class BodyReader;
+
+  enum class Outcome {
+    OK,
+    RETRY_FRESH,  // reused connection was dead, and the request can safely be sent again
+    FAILED
+  };
+
+  // How the end of the response body is determined (RFC 9112 section 6.3).
+  enum class Framing {
+    NONE,
+    CONTENT_LENGTH,
+    CHUNKED,
+    UNTIL_CLOSE
+  };
+
+  static bool ParseUrl(const std::string& url, Endpoint& endpoint);
+
+  std::unique_ptr<Connection> Acquire(const Endpoint& endpoint, bool& reused);
+  void Release(const Endpoint& endpoint, std::unique_ptr<Connection> connection);
+
+  // Writes the request and reads the response head; on OK, framing and
+  // contentLength describe the body still waiting on the connection.
+  static Outcome Exchange(Connection& connection, const Endpoint& endpoint, bool reused,
+                          const HttpRequest& request, HttpResponse& response, bool& keepAlive,
+                          Framing& framing, size_t& contentLength);
+
+  std::unique_ptr<HttpTransport> m_fallback;
+  const size_t m_maxIdlePerHost;
+
+  std::mutex m_poolMutex;
+  std::map<std::string, std::vector<std::unique_ptr<Connection>>> m_idle;  // "host:port" -> idle connections
+};
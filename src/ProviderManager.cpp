@@ -1,18 +1,36 @@
 #include "ProviderManager.h"
 #include "Utils.h"
+#include "ModelFields.h"
 #include <algorithm>
 
-bool ProviderManager::LoadProviders(const std::function<std::string(const std::string&)>& httpGet,
-                                    const std::function<bool(const std::string&, nlohmann::json&)>& parseJson) {
-  std::string response = httpGet("/api/providers");
+bool ProviderManager::LoadProviders(const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                                    const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                                    const LoadStatsSink& onStats) {
+  auto start = LoadStats::Clock::now();
+  LoadStats stats;
+  stats.ok = FetchProviders(httpGet, parseJson, stats);
+  stats.wallMs = LoadStats::MsSince(start);
+  if (onStats) onStats(stats);
+  return stats.ok;
+}
+
+bool ProviderManager::FetchProviders(const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                                     const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                                     LoadStats& stats) {
+  bool notModified = false;
+  std::string response = httpGet("/api/providers", m_data.Load()->loaded, notModified);
+  stats.notModified = notModified;
+  if (notModified) return true;
   if (response.empty()) return false;
+  stats.bytes = response.size();
+  auto parseStart = LoadStats::Clock::now();
 
   nlohmann::json document;
   if (!parseJson(response, document)) return false;
   if (!document.contains("providers") || !document["providers"].is_array()) return false;
 
-  std::vector<UltimateProvider> newProviders;
-  std::map<std::string, int> newProviderIdMap;
+  auto data = std::make_shared<Data>();
+  std::vector<UltimateProvider>& newProviders = data->providers;
 
   for (const auto& provider : document["providers"]) {
     if (provider.is_object() && provider.contains("name") && provider["name"].is_string()) {
@@ -24,8 +42,8 @@ bool ProviderManager::LoadProviders(const std::function<std::string(const std::s
       p.enabled = (provider.contains("enabled") && provider["enabled"].is_boolean()) ? provider["enabled"].get<bool>() : true;
       p.uniqueId = Utils::GenerateProviderUniqueId(p.name);
 
-      newProviders.push_back(p);
-      newProviderIdMap[p.name] = p.uniqueId;
+      data->providerIdMap[p.name] = p.uniqueId;
+      newProviders.push_back(std::move(p));
     }
   }
 
@@ -42,16 +60,34 @@ bool ProviderManager::LoadProviders(const std::function<std::string(const std::s
               return a.name < b.name;
             });
 
-  std::unique_lock<std::shared_mutex> lock(m_dataMutex);
-  m_providers = std::move(newProviders);
-  m_providerIdMap = std::move(newProviderIdMap);
+  data->fingerprint = ModelFields::Fingerprint(newProviders, [](const UltimateProvider& provider, auto& v) {
+    ModelFields::VisitProvider(provider, v);
+  });
+  data->loaded = true;
+  stats.items = newProviders.size();
+  stats.parseMs = LoadStats::MsSince(parseStart);
 
+  m_data.Store(std::move(data));
   return true;
 }
 
+void ProviderManager::RestoreProviders(std::vector<UltimateProvider> providers) {
+  auto data = std::make_shared<Data>();
+  for (const auto& provider : providers) data->providerIdMap[provider.name] = provider.uniqueId;
+  data->fingerprint = ModelFields::Fingerprint(providers, [](const UltimateProvider& provider, auto& v) {
+    ModelFields::VisitProvider(provider, v);
+  });
+  data->providers = std::move(providers);
+  m_data.Store(std::move(data));
+}
+
+uint64_t ProviderManager::GetFingerprint() const {
+  return m_data.Load()->fingerprint;
+}
+
 bool ProviderManager::GetProviders(kodi::addon::PVRProvidersResultSet& results) const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  for (const auto& provider : m_providers) {
+  auto data = m_data.Load();
+  for (const auto& provider : data->providers) {
     if (provider.enabled) {
       kodi::addon::PVRProvider kodiProvider;
       kodiProvider.SetName(provider.label.empty() ? provider.name : provider.label);
@@ -66,14 +102,13 @@ bool ProviderManager::GetProviders(kodi::addon::PVRProvidersResultSet& results)
 }
 
 int ProviderManager::GetProvidersAmount() const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  return std::ranges::count_if(m_providers,
+  return std::ranges::count_if(m_data.Load()->providers,
                                [](const UltimateProvider& p){ return p.enabled; });
 }
 
 std::string ProviderManager::GetProviderName(int uniqueId) const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  for (const auto& provider : m_providers) {
+  auto data = m_data.Load();
+  for (const auto& provider : data->providers) {
     if (provider.uniqueId == uniqueId) return provider.name;
   }
   return "";
@@ -1,34 +1,55 @@
 #pragma once
 
 #include "Models.h"
+#include "LoadStats.h"
+#include "AtomicSharedPtr.h"
 #include <kodi/addon-instance/PVR.h>
 #include <vector>
 #include <map>
-#include <shared_mutex>
-#include <mutex>
+#include <memory>
 #include <functional>
 #include <nlohmann/json.hpp>
 
 class ProviderManager {
 public:
+    // Immutable view of the held providers. Loads and restores publish a new
+    // one; callers that need the list across several calls (the per-dataset
+    // loads, AddTimer) hold on to one instead of re-reading the manager.
+    struct Data {
+        std::vector<UltimateProvider> providers;  // sorted by name, see FetchProviders
+        std::map<std::string, int> providerIdMap;  // name -> uniqueId
+        bool loaded = false;  // providers holds a successfully parsed response
+        uint64_t fingerprint = 0;
+    };
+
     ProviderManager() = default;
 
-    bool LoadProviders(const std::function<std::string(const std::string&)>& httpGet,
-                       const std::function<bool(const std::string&, nlohmann::json&)>& parseJson);
+    // httpGet(endpoint, conditional, notModified) is CPVRUltimate::HttpGetConditional:
+    // conditional is set only while the list from the previous load is still held,
+    // and a "not modified" answer keeps it as-is without re-parsing. onStats,
+    // if set, receives the request's cost (see LoadStats).
+    bool LoadProviders(const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                       const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                       const LoadStatsSink& onStats = nullptr);
+
+    // Serves providers from a warm-start snapshot. They are not marked as
+    // loaded, so the next LoadProviders fetches unconditionally.
+    void RestoreProviders(std::vector<UltimateProvider> providers);
 
     bool GetProviders(kodi::addon::PVRProvidersResultSet& results) const;
     int GetProvidersAmount() const;
 
-    std::string GetProviderName(int uniqueId) const;
-    const std::vector<UltimateProvider>& GetProviders() const { return m_providers; }
+    // Content fingerprint of the held providers (ModelFields::Fingerprint), for
+    // telling whether a load changed anything Kodi would see.
+    uint64_t GetFingerprint() const;
 
-    void LockShared() const { m_dataMutex.lock_shared(); }
-    void UnlockShared() const { m_dataMutex.unlock_shared(); }
-    void LockUnique() const { m_dataMutex.lock(); }
-    void UnlockUnique() const { m_dataMutex.unlock(); }
+    std::string GetProviderName(int uniqueId) const;
+    std::shared_ptr<const Data> GetData() const { return m_data.Load(); }
 
 private:
-    std::vector<UltimateProvider> m_providers;
-    std::map<std::string, int> m_providerIdMap;
-    mutable std::shared_mutex m_dataMutex;
+    bool FetchProviders(const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                        const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                        LoadStats& stats);
+
+    AtomicSharedPtr<const Data> m_data{std::make_shared<const Data>()};
 };
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include "RateLimiter.h"
+#include <algorithm>
+#include <thread>
+
+bool RateLimiter::Acquire(const std::function<bool()>& cancelled) {
+  const double rate = m_rate.load();
+  if (rate <= 0) return !cancelled();
+
+  Clock::time_point slot;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    slot = std::max(Clock::now(), m_next);
+    m_next = slot + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+  }
+
+  // Short naps, so a shutdown does not wait out a long queue of slots.
+  constexpr auto POLL = std::chrono::milliseconds(100);
+  for (Clock::time_point now = Clock::now(); now < slot; now = Clock::now()) {
+    if (cancelled()) return false;
+    std::this_thread::sleep_for(std::min<Clock::duration>(slot - now, POLL));
+  }
+  return !cancelled();
+}
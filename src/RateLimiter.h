@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+// Spaces requests evenly so that all threads sharing the limiter together
+// start at most a given number per second. Acquire() reserves the next free
+// slot and sleeps until it comes; there is no burst allowance, so a pool of
+// workers cannot hit the backend all at once either.
+class RateLimiter {
+public:
+  // 0 (or less) means unlimited.
+  explicit RateLimiter(double requestsPerSecond = 0) : m_rate(requestsPerSecond) {}
+
+  void SetRate(double requestsPerSecond) { m_rate = requestsPerSecond; }
+  double GetRate() const { return m_rate.load(); }
+
+  // Waits for the caller's slot. False if cancelled() turned true while
+  // waiting - the slot is then given up and the request should not be made.
+  bool Acquire(const std::function<bool()>& cancelled);
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  std::atomic<double> m_rate;
+  std::mutex m_mutex;
+  Clock::time_point m_next;
+};
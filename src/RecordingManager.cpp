@@ -1,107 +1,233 @@
 #include "RecordingManager.h"
 #include "Utils.h"
+#include "ModelFields.h"
+#include "DeltaSync.h"
+#include "JsonFieldTable.h"
 #include <kodi/General.h>
 #include <algorithm>
+#include <array>
 
 const std::set<std::string> RecordingManager::PLAYABLE_STATUSES = {"COMPLETED", "RECORDING"};
 
 bool RecordingManager::LoadRecordings(const std::vector<UltimateProvider>& providers,
-                                      const std::function<std::string(const std::string&)>& httpGet,
-                                      const std::function<bool(const std::string&, nlohmann::json&)>& parseJson) {
-  std::vector<UltimateRecording> newRecordings;
-
-  for (const auto& provider : providers) {
-    if (provider.enabled) {
-      LoadRecordingsForProvider(provider.name, httpGet, parseJson, newRecordings);
+                                      const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                                      const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                                      const FanOutExecutor& executor,
+                                      const LoadStatsSink& onStats) {
+  std::lock_guard<std::mutex> loadLock(m_loadMutex);
+  std::shared_ptr<const Data> heldData = m_data.Load();
+  const std::set<std::string>& loadedProviders = heldData->loadedProviders;
+  const std::map<std::string, std::string>& cursors = heldData->cursors;
+
+  std::vector<ProviderRecordings> perProvider(providers.size());
+  std::vector<char> loaded(providers.size(), 0);
+
+  executor.Run(providers.size(), [&](size_t i) {
+    if (!providers[i].enabled) return;
+    const std::string& provider = providers[i].name;
+    // A cursor only means something relative to recordings we still hold.
+    bool held = loadedProviders.contains(provider);
+    auto cursor = cursors.find(provider);
+    std::string since = (held && cursor != cursors.end()) ? cursor->second : "";
+
+    ProviderRecordings& result = perProvider[i];
+    auto start = LoadStats::Clock::now();
+    LoadStats stats;
+    stats.provider = provider;
+    stats.ok = LoadRecordingsForProvider(provider, held, since, httpGet, parseJson, result, stats);
+    if (onStats) {
+      stats.notModified = result.notModified;
+      stats.wallMs = LoadStats::MsSince(start);
+      onStats(stats);
+    }
+    if (!stats.ok) {
+      // A failed request keeps what is held for the provider (see
+      // ChannelManager::LoadChannels), cursor included.
+      if (!held) return;
+      result = ProviderRecordings();
+      result.notModified = true;
     }
+    if (result.notModified || result.delta) {
+      std::vector<UltimateRecording> current;
+      ReuseProviderRecordings(*heldData, provider, current);
+      if (result.delta) {
+        DeltaSync::Apply(current, std::move(result.recordings), result.removedIds,
+                         [](const UltimateRecording& rec) -> const std::string& { return rec.uniqueId; });
+      }
+      result.recordings = std::move(current);
+    }
+    if (result.notModified) result.cursor = since;
+    loaded[i] = 1;
+  });
+
+  auto data = std::make_shared<Data>();
+  size_t deltaProviders = 0;
+  for (size_t i = 0; i < providers.size(); ++i) {
+    if (!loaded[i]) continue;
+    ProviderRecordings& result = perProvider[i];
+    data->recordings.insert(data->recordings.end(), std::make_move_iterator(result.recordings.begin()),
+                            std::make_move_iterator(result.recordings.end()));
+    data->loadedProviders.insert(providers[i].name);
+    if (!result.cursor.empty()) data->cursors[providers[i].name] = std::move(result.cursor);
+    if (result.delta) deltaProviders++;
+  }
+  if (deltaProviders > 0) {
+    kodi::Log(ADDON_LOG_DEBUG, "Recordings: %zu of %zu providers delta-synced", deltaProviders,
+              data->loadedProviders.size());
   }
 
-  std::unique_lock<std::shared_mutex> lock(m_dataMutex);
-  m_recordings = std::move(newRecordings);
-
+  Publish(std::move(data));
   return true;
 }
 
-void RecordingManager::LoadRecordingsForProvider(const std::string& provider,
-                                                 const std::function<std::string(const std::string&)>& httpGet,
+static uint64_t RecordingsFingerprint(const std::vector<UltimateRecording>& recordings) {
+  return ModelFields::Fingerprint(recordings, [](const UltimateRecording& recording, auto& v) {
+    ModelFields::VisitRecording(recording, v);
+  });
+}
+
+void RecordingManager::Publish(std::shared_ptr<Data> data) {
+  data->fingerprint = RecordingsFingerprint(data->recordings);
+  std::lock_guard<std::mutex> lock(m_writeMutex);
+  m_data.Store(std::move(data));
+}
+
+void RecordingManager::ReuseProviderRecordings(const Data& held, const std::string& provider,
+                                               std::vector<UltimateRecording>& outRecordings) {
+  for (const auto& recording : held.recordings) {
+    if (recording.provider == provider) outRecordings.push_back(recording);
+  }
+}
+
+bool RecordingManager::LoadRecordingsForProvider(const std::string& provider, bool conditional, const std::string& since,
+                                                 const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
                                                  const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                                 std::vector<UltimateRecording>& outRecordings) {
-  std::string url = "/api/providers/" + Utils::UrlPathEncode(provider) + "/recordings";
-  std::string response = httpGet(url);
+                                                 ProviderRecordings& out, LoadStats& stats) {
+  std::string url = DeltaSync::AppendSince("/api/providers/" + Utils::UrlPathEncode(provider) + "/recordings", since);
+  // Delta URLs are one-off, there is nothing to revalidate.
+  std::string response = httpGet(url, conditional && since.empty(), out.notModified);
+  if (out.notModified) return true;
   if (response.empty()) {
     kodi::Log(ADDON_LOG_WARNING, "Empty response from %s", Utils::RedactUrl(url).c_str());
-    return;
+    return false;
   }
+  stats.bytes = response.size();
+  auto parseStart = LoadStats::Clock::now();
 
   nlohmann::json document;
-  if (!parseJson(response, document)) return;
-  if (!document.contains("recordings") || !document["recordings"].is_array()) return;
+  if (!parseJson(response, document)) return false;
+  if (!document.contains("recordings") || !document["recordings"].is_array()) return false;
+
+  out.delta = !since.empty() && document.contains("delta") && document["delta"].is_boolean() &&
+              document["delta"].get<bool>();
+  out.cursor = (document.contains("cursor") && document["cursor"].is_string()) ? document["cursor"].get<std::string>() : "";
+  if (out.delta && document.contains("removed") && document["removed"].is_array()) {
+    for (const auto& id : document["removed"]) {
+      if (id.is_string()) out.removedIds.push_back(id.get<std::string>());
+    }
+  }
 
-  for (const auto& recJson : document["recordings"]) {
+  for (auto& recJson : document["recordings"]) {
     UltimateRecording rec;
-    rec.provider = provider;
-
-    if (recJson.contains("Id") && recJson["Id"].is_string())
-      rec.uniqueId = recJson["Id"].get<std::string>();
-    else continue;
-
-    rec.title = (recJson.contains("Name") && recJson["Name"].is_string()) ? recJson["Name"].get<std::string>() : rec.uniqueId;
-    rec.channelName = (recJson.contains("ChannelName") && recJson["ChannelName"].is_string()) ? recJson["ChannelName"].get<std::string>() : "";
-    rec.channelUid = (recJson.contains("ChannelUid") && recJson["ChannelUid"].is_number_integer()) ? recJson["ChannelUid"].get<int>() : 0;
-    rec.isRadio = (recJson.contains("ChannelType") && recJson["ChannelType"].is_string() && recJson["ChannelType"].get<std::string>() == "RADIO");
-
-    rec.startTime = (recJson.contains("RecordingTime") && recJson["RecordingTime"].is_string()) ? Utils::ParseISO8601(recJson["RecordingTime"].get<std::string>()) : 0;
-    rec.durationSeconds = (recJson.contains("DurationSeconds") && recJson["DurationSeconds"].is_number_integer()) ? recJson["DurationSeconds"].get<int>() : 0;
-    rec.endTime = rec.startTime + rec.durationSeconds;
-    rec.firstAired = (recJson.contains("FirstAired") && recJson["FirstAired"].is_string()) ? recJson["FirstAired"].get<std::string>() : "";
-
-    rec.seasonNumber = (recJson.contains("SeasonNumber") && recJson["SeasonNumber"].is_number_integer()) ? recJson["SeasonNumber"].get<int>() : 0;
-    rec.episodeNumber = (recJson.contains("EpisodeNumber") && recJson["EpisodeNumber"].is_number_integer()) ? recJson["EpisodeNumber"].get<int>() : 0;
-    rec.episodeName = (recJson.contains("EpisodeName") && recJson["EpisodeName"].is_string()) ? recJson["EpisodeName"].get<std::string>() : "";
-    rec.seriesTitle = (recJson.contains("SeriesTitle") && recJson["SeriesTitle"].is_string()) ? recJson["SeriesTitle"].get<std::string>() : "";
-    rec.seriesId = (recJson.contains("SeriesId") && recJson["SeriesId"].is_string()) ? recJson["SeriesId"].get<std::string>() : "";
-
-    rec.plot = (recJson.contains("Plot") && recJson["Plot"].is_string()) ? recJson["Plot"].get<std::string>() : "";
-    rec.plotOutline = (recJson.contains("PlotOutline") && recJson["PlotOutline"].is_string()) ? recJson["PlotOutline"].get<std::string>() : "";
-    rec.genreDescription = (recJson.contains("GenreDescription") && recJson["GenreDescription"].is_string()) ? recJson["GenreDescription"].get<std::string>() : "";
-    rec.genreType = (recJson.contains("GenreType") && recJson["GenreType"].is_number_integer()) ? recJson["GenreType"].get<int>() : 0;
-    rec.genreSubType = (recJson.contains("GenreSubType") && recJson["GenreSubType"].is_number_integer()) ? recJson["GenreSubType"].get<int>() : 0;
-
-    rec.iconPath = (recJson.contains("IconPath") && recJson["IconPath"].is_string()) ? recJson["IconPath"].get<std::string>() : "";
-    rec.thumbnailUrl = (recJson.contains("ThumbnailUrl") && recJson["ThumbnailUrl"].is_string()) ? recJson["ThumbnailUrl"].get<std::string>() : "";
-    rec.fanartUrl = (recJson.contains("FanartUrl") && recJson["FanartUrl"].is_string()) ? recJson["FanartUrl"].get<std::string>() : "";
-
-    rec.playCount = (recJson.contains("PlayCount") && recJson["PlayCount"].is_number_integer()) ? recJson["PlayCount"].get<int>() : 0;
-    rec.lastPlayedPosition = (recJson.contains("LastPlayedPosition") && recJson["LastPlayedPosition"].is_number_integer()) ? recJson["LastPlayedPosition"].get<int>() : 0;
-
-    rec.directory = (recJson.contains("Directory") && recJson["Directory"].is_string()) ? recJson["Directory"].get<std::string>() : "";
-    rec.sizeInBytes = (recJson.contains("SizeInBytes") && recJson["SizeInBytes"].is_number_integer()) ? recJson["SizeInBytes"].get<int>() : 0;
-    rec.priority = (recJson.contains("Priority") && recJson["Priority"].is_number_integer()) ? recJson["Priority"].get<int>() : 0;
-    rec.lifetime = (recJson.contains("Lifetime") && recJson["Lifetime"].is_number_integer()) ? recJson["Lifetime"].get<int>() : 0;
-    rec.flags = (recJson.contains("Flags") && recJson["Flags"].is_string()) ? recJson["Flags"].get<std::string>() : "";
-    rec.clientProviderUid = (recJson.contains("ClientProviderUid") && recJson["ClientProviderUid"].is_number_integer()) ? recJson["ClientProviderUid"].get<int>() : 0;
-    rec.providerName = (recJson.contains("ProviderName") && recJson["ProviderName"].is_string()) ? recJson["ProviderName"].get<std::string>() : "";
-
-    rec.epgEventId = (recJson.contains("EpgEventId") && recJson["EpgEventId"].is_number_integer()) ? recJson["EpgEventId"].get<int>() : 0;
-    rec.releaseYear = (recJson.contains("ReleaseYear") && recJson["ReleaseYear"].is_number_integer()) ? recJson["ReleaseYear"].get<int>() : 0;
-
-    rec.status = (recJson.contains("Status") && recJson["Status"].is_string()) ? recJson["Status"].get<std::string>() : "";
-    rec.isPlayable = (PLAYABLE_STATUSES.contains(rec.status));
-    rec.isDeleted = (recJson.contains("IsDeleted") && recJson["IsDeleted"].is_boolean()) ? recJson["IsDeleted"].get<bool>() : false;
-
-    outRecordings.push_back(rec);
+    if (ParseRecording(recJson, provider, rec)) out.recordings.push_back(std::move(rec));
   }
+  stats.items = out.recordings.size();
+  stats.parseMs = LoadStats::MsSince(parseStart);
+  return true;
+}
+
+// Members of a recording entry that only feed derived UltimateRecording fields.
+struct DecodedRecording : UltimateRecording {
+  bool hasId = false;
+  bool hasTitle = false;
+};
+
+using RecordingField = JsonFieldTable::Fields<DecodedRecording>;
+static constexpr auto RECORDING_FIELDS = JsonFieldTable::Sorted(std::array{
+  RecordingField::Custom("Id", JsonFieldTable::Type::STRING, [](nlohmann::json& value, DecodedRecording& out) {
+    out.hasId = true;
+    out.uniqueId = std::move(value.get_ref<std::string&>());
+  }),
+  RecordingField::Custom("Name", JsonFieldTable::Type::STRING, [](nlohmann::json& value, DecodedRecording& out) {
+    out.hasTitle = true;
+    out.title = std::move(value.get_ref<std::string&>());
+  }),
+  RecordingField::String<&UltimateRecording::channelName>("ChannelName"),
+  RecordingField::Integer<&UltimateRecording::channelUid>("ChannelUid"),
+  RecordingField::Custom("ChannelType", JsonFieldTable::Type::STRING, [](nlohmann::json& value, DecodedRecording& out) {
+    out.isRadio = value.get_ref<const std::string&>() == "RADIO";
+  }),
+
+  RecordingField::Time<&UltimateRecording::startTime>("RecordingTime"),
+  RecordingField::Integer<&UltimateRecording::durationSeconds>("DurationSeconds"),
+  RecordingField::String<&UltimateRecording::firstAired>("FirstAired"),
+
+  RecordingField::Integer<&UltimateRecording::seasonNumber>("SeasonNumber"),
+  RecordingField::Integer<&UltimateRecording::episodeNumber>("EpisodeNumber"),
+  RecordingField::String<&UltimateRecording::episodeName>("EpisodeName"),
+  RecordingField::String<&UltimateRecording::seriesTitle>("SeriesTitle"),
+  RecordingField::String<&UltimateRecording::seriesId>("SeriesId"),
+
+  RecordingField::String<&UltimateRecording::plot>("Plot"),
+  RecordingField::String<&UltimateRecording::plotOutline>("PlotOutline"),
+  RecordingField::String<&UltimateRecording::genreDescription>("GenreDescription"),
+  RecordingField::Integer<&UltimateRecording::genreType>("GenreType"),
+  RecordingField::Integer<&UltimateRecording::genreSubType>("GenreSubType"),
+
+  RecordingField::String<&UltimateRecording::iconPath>("IconPath"),
+  RecordingField::String<&UltimateRecording::thumbnailUrl>("ThumbnailUrl"),
+  RecordingField::String<&UltimateRecording::fanartUrl>("FanartUrl"),
+
+  RecordingField::Integer<&UltimateRecording::playCount>("PlayCount"),
+  RecordingField::Integer<&UltimateRecording::lastPlayedPosition>("LastPlayedPosition"),
+
+  RecordingField::String<&UltimateRecording::directory>("Directory"),
+  RecordingField::Integer<&UltimateRecording::sizeInBytes>("SizeInBytes"),
+  RecordingField::Integer<&UltimateRecording::priority>("Priority"),
+  RecordingField::Integer<&UltimateRecording::lifetime>("Lifetime"),
+  RecordingField::String<&UltimateRecording::flags>("Flags"),
+  RecordingField::Integer<&UltimateRecording::clientProviderUid>("ClientProviderUid"),
+  RecordingField::String<&UltimateRecording::providerName>("ProviderName"),
+
+  RecordingField::Integer<&UltimateRecording::epgEventId>("EpgEventId"),
+  RecordingField::Integer<&UltimateRecording::releaseYear>("ReleaseYear"),
+
+  RecordingField::String<&UltimateRecording::status>("Status"),
+  RecordingField::Boolean<&UltimateRecording::isDeleted>("IsDeleted"),
+});
+
+bool RecordingManager::ParseRecording(nlohmann::json& recJson, const std::string& provider,
+                                      UltimateRecording& rec) {
+  DecodedRecording decoded;
+  JsonFieldTable::Decode(recJson, RECORDING_FIELDS, decoded);
+  if (!decoded.hasId) return false;
+
+  rec = std::move(static_cast<UltimateRecording&>(decoded));
+  rec.provider = provider;
+  if (!decoded.hasTitle) rec.title = rec.uniqueId;
+  rec.endTime = rec.startTime + rec.durationSeconds;
+  rec.isPlayable = (PLAYABLE_STATUSES.contains(rec.status));
+  return true;
+}
+
+void RecordingManager::RestoreRecordings(std::vector<UltimateRecording> recordings) {
+  auto data = std::make_shared<Data>();
+  data->recordings = std::move(recordings);
+  Publish(std::move(data));
+}
+
+uint64_t RecordingManager::GetFingerprint() const {
+  return m_data.Load()->fingerprint;
 }
 
 int RecordingManager::GetRecordingsAmount(bool deleted) const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  return std::ranges::count_if(m_recordings,
+  return std::ranges::count_if(m_data.Load()->recordings,
                                [deleted](const UltimateRecording& r){ return r.isDeleted == deleted; });
 }
 
 bool RecordingManager::GetRecordings(bool deleted, kodi::addon::PVRRecordingsResultSet& results) const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  for (const auto& recording : m_recordings) {
+  auto data = m_data.Load();
+  for (const auto& recording : data->recordings) {
     if (recording.isDeleted != deleted) continue;
 
     kodi::addon::PVRRecording kodiRecording;
@@ -172,30 +298,30 @@ bool RecordingManager::DeleteRecording(const std::string& recordingId,
                                        const std::function<std::string(const std::string&)>& buildApiUrl,
                                        const std::function<bool(const std::string&)>& httpDelete) {
   std::string provider;
-  bool found = false;
-
   {
-    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-    UltimateRecording* rec = FindRecording(recordingId);
+    auto data = m_data.Load();
+    const UltimateRecording* rec = FindRecording(*data, recordingId);
     if (!rec) return false;
     provider = rec->provider;
-    found = true;
   }
 
-  if (!found) return false;
-
   if (!httpDelete(buildApiUrl("/api/providers/" + Utils::UrlPathEncode(provider) +
                               "/recordings/" + Utils::UrlPathEncode(recordingId)))) {
     return false;
   }
 
-  {
-    std::unique_lock<std::shared_mutex> lock(m_dataMutex);
-    if (UltimateRecording* rec = FindRecording(recordingId)) {
-      rec->isDeleted = true;
-    }
+  // Copy-on-write: readers holding the current snapshot keep seeing it
+  // unchanged. The next load replaces this anyway.
+  std::lock_guard<std::mutex> loadLock(m_loadMutex);
+  std::lock_guard<std::mutex> lock(m_writeMutex);
+  auto current = m_data.Load();
+  if (!FindRecording(*current, recordingId)) return true;
+  auto data = std::make_shared<Data>(*current);
+  for (auto& rec : data->recordings) {
+    if (rec.uniqueId == recordingId) rec.isDeleted = true;
   }
-
+  data->fingerprint = RecordingsFingerprint(data->recordings);
+  m_data.Store(std::move(data));
   return true;
 }
 
@@ -213,8 +339,8 @@ bool RecordingManager::GetRecordingStreamProperties(const std::string& recording
   streamHeadersBase64.clear();
 
   {
-    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-    UltimateRecording* rec = FindRecording(recordingId);
+    auto data = m_data.Load();
+    const UltimateRecording* rec = FindRecording(*data, recordingId);
     if (!rec || !rec->isPlayable) return false;
     provider = rec->provider;
     uniqueId = rec->uniqueId;
@@ -252,8 +378,8 @@ bool RecordingManager::GetRecordingEdl(const std::string& recordingId, std::vect
   return false;
 }
 
-UltimateRecording* RecordingManager::FindRecording(const std::string& recordingId) {
-  for (auto& rec : m_recordings) {
+const UltimateRecording* RecordingManager::FindRecording(const Data& data, const std::string& recordingId) {
+  for (const auto& rec : data.recordings) {
     if (rec.uniqueId == recordingId) return &rec;
   }
   return nullptr;
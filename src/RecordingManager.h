@@ -1,22 +1,49 @@
 #pragma once
 
 #include "Models.h"
+#include "FanOutExecutor.h"
+#include "LoadStats.h"
+#include "AtomicSharedPtr.h"
 #include <kodi/addon-instance/PVR.h>
 #include <vector>
-#include <shared_mutex>
+#include <memory>
 #include <mutex>
 #include <functional>
 #include <string>
 #include <set>
+#include <map>
 #include <nlohmann/json.hpp>
 
 class RecordingManager {
 public:
+  // Immutable view of the held recordings, published whole by every load,
+  // restore or delete (see AtomicSharedPtr).
+  struct Data {
+    std::vector<UltimateRecording> recordings;
+    std::set<std::string> loadedProviders;  // providers whose recordings came from a usable response
+    std::map<std::string, std::string> cursors;  // provider -> delta-sync cursor of its last response
+    uint64_t fingerprint = 0;
+  };
+
   RecordingManager() = default;
 
+  // httpGet has the conditional-GET contract described at
+  // ProviderManager::LoadProviders. Providers are fetched in parallel on
+  // executor, results are merged in providers order. Providers whose backend
+  // hands out change cursors are delta-synced (see DeltaSync.h). onStats,
+  // if set, receives each enabled provider's LoadStats.
   bool LoadRecordings(const std::vector<UltimateProvider>& providers,
-                      const std::function<std::string(const std::string&)>& httpGet,
-                      const std::function<bool(const std::string&, nlohmann::json&)>& parseJson);
+                      const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                      const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                      const FanOutExecutor& executor,
+                      const LoadStatsSink& onStats = nullptr);
+
+  // Serves recordings from a warm-start snapshot until the next load.
+  void RestoreRecordings(std::vector<UltimateRecording> recordings);
+
+  // Content fingerprint of the held recordings (ModelFields::Fingerprint), for
+  // telling whether a load changed anything Kodi would see.
+  uint64_t GetFingerprint() const;
 
   int GetRecordingsAmount(bool deleted) const;
   bool GetRecordings(bool deleted, kodi::addon::PVRRecordingsResultSet& results) const;
@@ -44,24 +71,48 @@ public:
 
   static bool GetRecordingEdl(const std::string& recordingId, std::vector<kodi::addon::PVREDLEntry>& edl);
 
-  UltimateRecording* FindRecording(const std::string& recordingId);
-  const std::vector<UltimateRecording>& GetRecordings() const { return m_recordings; }
-
-  void LockShared() const { m_dataMutex.lock_shared(); }
-  void UnlockShared() const { m_dataMutex.unlock_shared(); }
-  void LockUnique() const { m_dataMutex.lock(); }
-  void UnlockUnique() const { m_dataMutex.unlock(); }
+  static const UltimateRecording* FindRecording(const Data& data, const std::string& recordingId);
+  std::shared_ptr<const Data> GetData() const { return m_data.Load(); }
 
 private:
-  static void LoadRecordingsForProvider(const std::string& provider,
-                                        const std::function<std::string(const std::string&)>& httpGet,
+  // One provider's load result. With delta set, recordings holds only the
+  // added/changed entries relative to what is held for the provider.
+  struct ProviderRecordings {
+    bool notModified = false;
+    bool delta = false;
+    std::vector<UltimateRecording> recordings;
+    std::vector<std::string> removedIds;
+    std::string cursor;  // for the next delta request, "" if the backend has none
+  };
+
+  // Returns true if the provider's recordings were loaded (or, with
+  // notModified set, are unchanged and nothing was added to the output).
+  // since is the provider's delta cursor, "" for a full load.
+  static bool LoadRecordingsForProvider(const std::string& provider, bool conditional, const std::string& since,
+                                        const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
                                         const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                        std::vector<UltimateRecording>& outRecordings);
+                                        ProviderRecordings& out, LoadStats& stats);
+  // Decodes one "recordings" entry (see RECORDING_FIELDS), moving its strings
+  // out of recJson. False if it has no "Id".
+  static bool ParseRecording(nlohmann::json& recJson, const std::string& provider, UltimateRecording& rec);
+
+  static void ReuseProviderRecordings(const Data& held, const std::string& provider,
+                                      std::vector<UltimateRecording>& outRecordings);
+  // Fills in data's fingerprint, then publishes it.
+  void Publish(std::shared_ptr<Data> data);
 
   static bool MapRecordingToKodi(const UltimateRecording& recording, kodi::addon::PVRRecording& kodiRecording);
 
-  std::vector<UltimateRecording> m_recordings;
-  mutable std::shared_mutex m_dataMutex;
+  AtomicSharedPtr<const Data> m_data{std::make_shared<const Data>()};
+  // Held by LoadRecordings from reading the held snapshot to publishing, so
+  // a refresh and a reload after a change cannot publish out of order, and
+  // by DeleteRecording's copy-on-write, which then applies on top of a
+  // load's result rather than being overwritten by it. Taken before
+  // m_writeMutex.
+  std::mutex m_loadMutex;
+  // Held by DeleteRecording's copy-on-write and by Publish, so a copy made
+  // from one snapshot is never published over a newer one.
+  std::mutex m_writeMutex;
   
   static const std::set<std::string> PLAYABLE_STATUSES;
 };
\ No newline at end of file
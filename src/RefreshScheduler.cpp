@@ -0,0 +1,124 @@
+#include "RefreshScheduler.h"
+#include <kodi/General.h>
+#include <exception>
+
+void RefreshScheduler::AddJob(const std::string& name, int intervalSeconds, Job job) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry entry;
+  entry.name = name;
+  entry.intervalSeconds = intervalSeconds;
+  entry.job = std::move(job);
+  entry.due = NextDue(intervalSeconds);
+  m_jobs.push_back(std::move(entry));
+  m_cv.notify_all();
+}
+
+void RefreshScheduler::SetInterval(const std::string& name, int intervalSeconds) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry* entry = Find(name);
+  if (!entry) return;
+  entry->intervalSeconds = intervalSeconds;
+  entry->due = NextDue(intervalSeconds);
+  m_cv.notify_all();
+}
+
+void RefreshScheduler::RunSoon(const std::string& name) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry* entry = Find(name);
+  if (!entry) return;
+  entry->due = Clock::now();
+  m_cv.notify_all();
+}
+
+void RefreshScheduler::Start() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_running) return;
+  for (auto& entry : m_jobs) entry.due = NextDue(entry.intervalSeconds);
+  m_stop = false;
+  m_running = true;
+  m_thread = std::thread(&RefreshScheduler::Worker, this);
+}
+
+void RefreshScheduler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running) return;
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  if (m_thread.joinable()) m_thread.join();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_running = false;
+}
+
+bool RefreshScheduler::StopRequested() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stop;
+}
+
+void RefreshScheduler::Pause() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_pauseCount++;
+}
+
+void RefreshScheduler::Resume() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pauseCount > 0) m_pauseCount--;
+  }
+  m_cv.notify_all();
+}
+
+RefreshScheduler::Clock::time_point RefreshScheduler::NextDue(int intervalSeconds) {
+  if (intervalSeconds <= 0) return Clock::time_point::max();
+  std::uniform_real_distribution<double> jitter(0.9, 1.1);
+  auto delay = std::chrono::duration<double>(intervalSeconds * jitter(m_rng));
+  return Clock::now() + std::chrono::duration_cast<Clock::duration>(delay);
+}
+
+RefreshScheduler::Entry* RefreshScheduler::Find(const std::string& name) {
+  for (auto& entry : m_jobs) {
+    if (entry.name == name) return &entry;
+  }
+  return nullptr;
+}
+
+void RefreshScheduler::Worker() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_stop) {
+    if (m_pauseCount > 0) {
+      m_cv.wait(lock, [this]() { return m_stop || m_pauseCount == 0; });
+      continue;
+    }
+
+    Entry* next = nullptr;
+    for (auto& entry : m_jobs) {
+      if (!next || entry.due < next->due) next = &entry;
+    }
+    if (!next || next->due == Clock::time_point::max()) {
+      // Nothing enabled; AddJob/SetInterval/RunSoon/Stop notify.
+      m_cv.wait(lock);
+      continue;
+    }
+    if (Clock::now() < next->due) {
+      m_cv.wait_until(lock, next->due);
+      continue;  // re-evaluate: woken early by a change, a pause or Stop()
+    }
+
+    next->due = NextDue(next->intervalSeconds);
+    std::string name = next->name;
+    Job job = next->job;  // m_jobs may change while unlocked
+
+    lock.unlock();
+    kodi::Log(ADDON_LOG_DEBUG, "Background refresh: %s", name.c_str());
+    try {
+      job();
+    } catch (const std::exception& e) {
+      kodi::Log(ADDON_LOG_ERROR, "Background refresh of %s failed: %s", name.c_str(), e.what());
+    } catch (...) {
+      kodi::Log(ADDON_LOG_ERROR, "Background refresh of %s failed: unknown exception", name.c_str());
+    }
+    lock.lock();
+  }
+}
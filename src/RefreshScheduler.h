@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <random>
+
+// Periodic background refresh of the list datasets. Each job has its own
+// interval (0 = disabled) and all jobs run one at a time on a single worker
+// thread. Every interval gets +-10% jitter, so clients started together
+// (e.g. several Kodi boxes powered on by the same timer) drift apart instead
+// of hitting the backend in lockstep.
+//
+// While paused (playback is being set up, see PauseScope) no job is started;
+// one already running is not interrupted. Stop() cancels whatever is pending
+// and joins the worker; jobs that run long should check StopRequested().
+class RefreshScheduler {
+public:
+  using Job = std::function<void()>;
+
+  RefreshScheduler() : m_rng(std::random_device{}()) {}
+  ~RefreshScheduler() { Stop(); }
+  RefreshScheduler(const RefreshScheduler&) = delete;
+  RefreshScheduler& operator=(const RefreshScheduler&) = delete;
+
+  void AddJob(const std::string& name, int intervalSeconds, Job job);
+  // Takes effect from now: the job next runs one (jittered) new interval
+  // from now, or never with 0.
+  void SetInterval(const std::string& name, int intervalSeconds);
+  // Runs the job as soon as the worker is free (and not paused), e.g. the
+  // channel refresh after the provider list changed.
+  void RunSoon(const std::string& name);
+
+  // Start() schedules every job one interval from now; calling it while
+  // running is a no-op.
+  void Start();
+  void Stop();
+  bool StopRequested() const;
+
+  void Pause();
+  void Resume();
+
+  class PauseScope {
+  public:
+    explicit PauseScope(RefreshScheduler& scheduler) : m_scheduler(scheduler) { m_scheduler.Pause(); }
+    ~PauseScope() { m_scheduler.Resume(); }
+    PauseScope(const PauseScope&) = delete;
+    PauseScope& operator=(const PauseScope&) = delete;
+
+  private:
+    RefreshScheduler& m_scheduler;
+  };
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    std::string name;
+    int intervalSeconds = 0;
+    Job job;
+    Clock::time_point due;
+  };
+
+  void Worker();
+  Clock::time_point NextDue(int intervalSeconds);  // requires m_mutex
+  Entry* Find(const std::string& name);            // requires m_mutex
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::vector<Entry> m_jobs;
+  std::thread m_thread;
+  bool m_running = false;
+  bool m_stop = false;
+  int m_pauseCount = 0;
+  std::mt19937 m_rng;
+};
@@ -0,0 +1,116 @@
+#include "RetryPolicy.h"
+#include <kodi/General.h>
+#include <algorithm>
+#include <random>
+
+RetryPolicy RetryPolicy::For(RequestClass requestClass, int configuredRetries, int configuredDelayMs) {
+  RetryPolicy policy;
+  switch (requestClass) {
+    case RequestClass::PLAYBACK:
+      // The user is staring at a spinner: a couple of quick retries, then fail.
+      policy.maxAttempts = 3;
+      policy.baseDelayMs = 250;
+      policy.maxDelayMs = 1000;
+      policy.deadlineMs = 5000;
+      break;
+    case RequestClass::EPG:
+      policy.maxAttempts = 3;
+      policy.baseDelayMs = 500;
+      policy.maxDelayMs = 2000;
+      policy.deadlineMs = 10000;
+      break;
+    case RequestClass::BACKGROUND:
+    default:
+      policy.maxAttempts = std::max(1, configuredRetries) + 1;
+      policy.baseDelayMs = std::max(100, configuredDelayMs);
+      policy.maxDelayMs = std::max(policy.baseDelayMs, 30000);
+      // Same order of magnitude as the old fixed-delay loop's worst case
+      // (retries * delay), plus headroom for the exponential tail.
+      policy.deadlineMs = std::max(30000, 2 * policy.maxAttempts * policy.baseDelayMs);
+      break;
+  }
+  return policy;
+}
+
+int RetryPolicy::BackoffMs(int attempt) const {
+  thread_local std::mt19937 rng{std::random_device{}()};
+
+  long long capped = baseDelayMs;
+  for (int i = 0; i < attempt && capped < maxDelayMs; ++i) capped *= 2;
+  capped = std::min<long long>(capped, maxDelayMs);
+
+  int half = static_cast<int>(capped / 2);
+  std::uniform_int_distribution<int> jitter(0, std::max(0, static_cast<int>(capped) - half));
+  return half + jitter(rng);
+}
+
+const char* RetryPolicy::ClassName(RequestClass requestClass) {
+  switch (requestClass) {
+    case RequestClass::PLAYBACK: return "playback";
+    case RequestClass::EPG: return "epg";
+    case RequestClass::BACKGROUND: return "background";
+  }
+  return "unknown";
+}
+
+std::string CircuitBreaker::EndpointKey(const std::string& url) {
+  size_t pos = url.find("://");
+  pos = (pos == std::string::npos) ? 0 : pos + 3;
+  size_t end = url.find_first_of("/?|", pos);
+  for (int segment = 0; segment < 3 && end != std::string::npos && url[end] == '/'; ++segment) {
+    end = url.find_first_of("/?|", end + 1);
+  }
+  return url.substr(0, end);
+}
+
+bool CircuitBreaker::Allow(const std::string& endpoint) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(endpoint);
+  if (it == m_entries.end()) return true;
+
+  Entry& entry = it->second;
+  switch (entry.state) {
+    case State::CLOSED:
+      return true;
+    case State::HALF_OPEN:
+      // A trial request is already in flight.
+      return false;
+    case State::OPEN: {
+      auto openMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - entry.openedAt).count();
+      if (openMs < OPEN_COOLDOWN_MS) return false;
+      entry.state = State::HALF_OPEN;
+      kodi::Log(ADDON_LOG_INFO, "Circuit half-open for %s, sending trial request", endpoint.c_str());
+      return true;
+    }
+  }
+  return true;
+}
+
+void CircuitBreaker::RecordSuccess(const std::string& endpoint) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(endpoint);
+  if (it == m_entries.end()) return;
+  if (it->second.state != State::CLOSED) {
+    kodi::Log(ADDON_LOG_INFO, "Circuit closed for %s", endpoint.c_str());
+  }
+  m_entries.erase(it);
+}
+
+void CircuitBreaker::RecordFailure(const std::string& endpoint) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry& entry = m_entries[endpoint];
+  entry.consecutiveFailures++;
+  if (entry.state == State::HALF_OPEN ||
+      (entry.state == State::CLOSED && entry.consecutiveFailures >= FAILURE_THRESHOLD)) {
+    entry.state = State::OPEN;
+    entry.openedAt = std::chrono::steady_clock::now();
+    kodi::Log(ADDON_LOG_WARNING, "Circuit open for %s after %d consecutive failures - failing fast for %d ms",
+              endpoint.c_str(), entry.consecutiveFailures, OPEN_COOLDOWN_MS);
+  }
+}
+
+void CircuitBreaker::Reset() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+}
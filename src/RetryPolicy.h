@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <utility>
+
+// Who is waiting on a request decides how long it may keep retrying.
+// Playback blocks the user's zap, EPG blocks Kodi's EPG thread, background
+// loads block nothing interactive.
+enum class RequestClass {
+  PLAYBACK,
+  EPG,
+  BACKGROUND
+};
+
+struct RetryPolicy {
+  int maxAttempts = 1;   // including the first attempt
+  int baseDelayMs = 0;
+  int maxDelayMs = 0;
+  int deadlineMs = 0;    // total budget for the call, sleeps included
+
+  // BACKGROUND is derived from the user's retry_attempts/retry_delay
+  // settings; PLAYBACK and EPG use fixed, much tighter budgets.
+  static RetryPolicy For(RequestClass requestClass, int configuredRetries, int configuredDelayMs);
+
+  // Exponential backoff with "equal jitter": half of the capped exponential
+  // delay is fixed, the other half random, so concurrent clients spread out
+  // without any single retry collapsing to zero delay.
+  int BackoffMs(int attempt) const;
+
+  // Transport failures (status 0), 5xx and 429 are worth retrying; any other
+  // status means the backend answered and will answer the same again.
+  static bool IsRetryable(int status) { return status == 0 || status == 429 || status >= 500; }
+
+  static const char* ClassName(RequestClass requestClass);
+};
+
+// Per-endpoint circuit breaker. After FAILURE_THRESHOLD consecutive
+// retryable failures the endpoint is "open" and requests fail immediately
+// for OPEN_COOLDOWN_MS; then a single trial request is let through
+// (half-open) and its outcome closes or re-opens the circuit.
+class CircuitBreaker {
+public:
+  static constexpr int FAILURE_THRESHOLD = 5;
+  static constexpr int OPEN_COOLDOWN_MS = 30000;
+
+  CircuitBreaker() = default;
+
+  // Scheme + authority + first three path segments, e.g.
+  // "http://host:7777/api/providers/joyn_de" - one breaker per provider,
+  // so one provider's broken upstream does not block the others.
+  static std::string EndpointKey(const std::string& url);
+
+  bool Allow(const std::string& endpoint);
+  void RecordSuccess(const std::string& endpoint);
+  void RecordFailure(const std::string& endpoint);
+  void Reset();
+
+  // One request Allow() let through. Unless Succeeded() or Failed() was
+  // called, it records a failure when it goes out of scope, so a request
+  // that throws cannot leave a half-open circuit waiting for its trial.
+  class Attempt {
+  public:
+    Attempt(CircuitBreaker& breaker, std::string endpoint)
+        : m_breaker(breaker), m_endpoint(std::move(endpoint)) {}
+    ~Attempt() {
+      if (!m_recorded) m_breaker.RecordFailure(m_endpoint);
+    }
+    Attempt(const Attempt&) = delete;
+    Attempt& operator=(const Attempt&) = delete;
+
+    void Succeeded() {
+      m_recorded = true;
+      m_breaker.RecordSuccess(m_endpoint);
+    }
+    void Failed() {
+      m_recorded = true;
+      m_breaker.RecordFailure(m_endpoint);
+    }
+
+  private:
+    CircuitBreaker& m_breaker;
+    std::string m_endpoint;
+    bool m_recorded = false;
+  };
+
+private:
+  enum class State { CLOSED, OPEN, HALF_OPEN };
+  struct Entry {
+    State state = State::CLOSED;
+    int consecutiveFailures = 0;
+    std::chrono::steady_clock::time_point openedAt;
+  };
+
+  std::mutex m_mutex;
+  std::map<std::string, Entry> m_entries;
+};
@@ -0,0 +1,38 @@
+#include "SingleFlight.h"
+
+std::string SingleFlight::Do(const std::string& key, const std::function<std::string()>& fn) {
+  std::shared_ptr<Call> call;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_calls.find(key);
+    if (it != m_calls.end()) {
+      call = it->second;
+      m_cv.wait(lock, [&call]() { return call->done; });
+      m_coalesced++;
+      m_coalescedBytes += call->result.size();
+      return call->result;
+    }
+    call = std::make_shared<Call>();
+    m_calls.emplace(key, call);
+  }
+
+  m_executed++;
+  std::string result;
+  try {
+    result = fn();
+  } catch (...) {
+    // Waiters get an empty (failed) result rather than hanging forever.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    call->done = true;
+    m_calls.erase(key);
+    m_cv.notify_all();
+    throw;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  call->result = result;
+  call->done = true;
+  m_calls.erase(key);
+  m_cv.notify_all();
+  return result;
+}
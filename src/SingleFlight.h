@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+// Coalesces concurrent identical requests: while a call for a given key is
+// in flight, further callers with the same key block until it finishes and
+// receive a copy of its result instead of issuing their own request. Nothing
+// is cached - once the leading call returns, the next caller starts a new one.
+class SingleFlight {
+public:
+  SingleFlight() = default;
+
+  std::string Do(const std::string& key, const std::function<std::string()>& fn);
+
+  uint64_t GetExecutedCount() const { return m_executed.load(); }
+  uint64_t GetCoalescedCount() const { return m_coalesced.load(); }
+  // Response bytes handed to coalesced callers, i.e. transfer the backend
+  // did not have to repeat.
+  uint64_t GetCoalescedBytes() const { return m_coalescedBytes.load(); }
+
+private:
+  struct Call {
+    bool done = false;
+    std::string result;
+  };
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::map<std::string, std::shared_ptr<Call>> m_calls;
+
+  std::atomic<uint64_t> m_executed{0};
+  std::atomic<uint64_t> m_coalesced{0};
+  std::atomic<uint64_t> m_coalescedBytes{0};
+};
@@ -0,0 +1,262 @@
+#include "Snapshot.h"
+#include "ModelFields.h"
+#include "MappedFile.h"
+#include <kodi/General.h>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <type_traits>
+
+namespace {
+
+constexpr char MAGIC[8] = {'U', 'P', 'V', 'R', 'S', 'N', 'A', 'P'};
+
+enum SectionId : uint32_t {
+  SECTION_SOURCE = 1,
+  SECTION_PROVIDERS,
+  SECTION_CHANNELS,
+  SECTION_TIMER_TYPES,
+  SECTION_RECORDINGS,
+  SECTION_TIMERS,
+  SECTION_COUNT = SECTION_TIMERS
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t sectionCount;
+  uint64_t fileSize;
+  uint64_t stringsOffset;
+  uint64_t stringsSize;
+  uint64_t checksum;  // FNV-1a over everything after the header
+};
+
+struct SectionEntry {
+  uint32_t id;
+  uint32_t fieldsPerRecord;
+  uint64_t recordCount;
+  uint64_t offset;
+};
+
+static_assert(sizeof(Header) % 8 == 0 && sizeof(SectionEntry) % 8 == 0, "snapshot structs must stay 8-byte aligned");
+
+uint64_t Fnv1a(const uint8_t* data, size_t size) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Snapshot-only records; the model field lists live in ModelFields.h.
+template <class S, class V> void VisitSource(S& source, V& v) {
+  v(source);
+}
+
+struct FieldCounter {
+  uint32_t count = 0;
+  template <class T> void operator()(const T&) { count++; }
+};
+
+template <class Record, class VisitFn> uint32_t CountFields(VisitFn visit) {
+  Record record{};
+  FieldCounter counter;
+  visit(record, counter);
+  return counter.count;
+}
+
+class Writer {
+public:
+  void operator()(const std::string& value) {
+    uint64_t offset = m_strings.size();
+    m_strings.append(value);
+    m_slots.push_back((offset << 32) | static_cast<uint32_t>(value.size()));
+  }
+  template <class N> void operator()(const N& value) {
+    static_assert(std::is_arithmetic_v<N>, "snapshot fields must be strings or numbers");
+    m_slots.push_back(static_cast<uint64_t>(static_cast<int64_t>(value)));
+  }
+
+  template <class Range, class VisitFn>
+  void AddSection(uint32_t id, uint32_t fieldsPerRecord, const Range& records, VisitFn visit) {
+    SectionEntry entry{id, fieldsPerRecord, 0, m_slots.size() * sizeof(uint64_t)};
+    for (const auto& record : records) {
+      visit(record, *this);
+      entry.recordCount++;
+    }
+    m_sections.push_back(entry);
+  }
+
+  std::vector<uint64_t> m_slots;
+  std::string m_strings;
+  std::vector<SectionEntry> m_sections;
+};
+
+class Reader {
+public:
+  Reader(const uint64_t* slots, const char* strings, uint64_t stringsSize)
+      : m_slots(slots), m_strings(strings), m_stringsSize(stringsSize) {}
+
+  void operator()(std::string& value) {
+    uint64_t slot = *m_slots++;
+    uint64_t offset = slot >> 32;
+    uint64_t length = slot & 0xFFFFFFFFull;
+    if (offset + length > m_stringsSize) {
+      m_ok = false;
+      value.clear();
+      return;
+    }
+    value.assign(m_strings + offset, length);
+  }
+  template <class N> void operator()(N& value) {
+    value = static_cast<N>(static_cast<int64_t>(*m_slots++));
+  }
+
+  bool Ok() const { return m_ok; }
+
+private:
+  const uint64_t* m_slots;
+  const char* m_strings;
+  uint64_t m_stringsSize;
+  bool m_ok = true;
+};
+
+const uint32_t SOURCE_FIELDS = CountFields<std::string>([](auto& r, auto& v) { VisitSource(r, v); });
+const uint32_t PROVIDER_FIELDS = CountFields<UltimateProvider>([](auto& r, auto& v) { ModelFields::VisitProvider(r, v); });
+const uint32_t CHANNEL_FIELDS = CountFields<UltimateChannel>([](auto& r, auto& v) { ModelFields::VisitChannel(r, v); });
+const uint32_t TIMER_TYPE_FIELDS = CountFields<UltimateTimerType>([](auto& r, auto& v) { ModelFields::VisitTimerType(r, v); });
+const uint32_t RECORDING_FIELDS = CountFields<UltimateRecording>([](auto& r, auto& v) { ModelFields::VisitRecording(r, v); });
+const uint32_t TIMER_FIELDS = CountFields<UltimateTimer>([](auto& r, auto& v) { ModelFields::VisitTimer(r, v); });
+
+}  // namespace
+
+bool Snapshot::Save(const std::string& path, const Data& data) {
+  Writer writer;
+  writer.AddSection(SECTION_SOURCE, SOURCE_FIELDS, std::vector<std::string>{data.source},
+                    [](const std::string& r, Writer& w) { VisitSource(r, w); });
+  writer.AddSection(SECTION_PROVIDERS, PROVIDER_FIELDS, data.providers,
+                    [](const UltimateProvider& r, Writer& w) { ModelFields::VisitProvider(r, w); });
+  writer.AddSection(SECTION_CHANNELS, CHANNEL_FIELDS, data.channels,
+                    [](const UltimateChannel& r, Writer& w) { ModelFields::VisitChannel(r, w); });
+  writer.AddSection(SECTION_TIMER_TYPES, TIMER_TYPE_FIELDS, data.timerTypes,
+                    [](const UltimateTimerType& r, Writer& w) { ModelFields::VisitTimerType(r, w); });
+  writer.AddSection(SECTION_RECORDINGS, RECORDING_FIELDS, data.recordings,
+                    [](const UltimateRecording& r, Writer& w) { ModelFields::VisitRecording(r, w); });
+  writer.AddSection(SECTION_TIMERS, TIMER_FIELDS, data.timers,
+                    [](const UltimateTimer& r, Writer& w) { ModelFields::VisitTimer(r, w); });
+
+  const uint64_t recordsOffset = sizeof(Header) + writer.m_sections.size() * sizeof(SectionEntry);
+  for (auto& section : writer.m_sections) section.offset += recordsOffset;
+
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.sectionCount = static_cast<uint32_t>(writer.m_sections.size());
+  header.stringsOffset = recordsOffset + writer.m_slots.size() * sizeof(uint64_t);
+  header.stringsSize = writer.m_strings.size();
+  header.fileSize = header.stringsOffset + header.stringsSize;
+
+  std::string payload;
+  payload.reserve(header.fileSize - sizeof(Header));
+  payload.append(reinterpret_cast<const char*>(writer.m_sections.data()),
+                 writer.m_sections.size() * sizeof(SectionEntry));
+  payload.append(reinterpret_cast<const char*>(writer.m_slots.data()), writer.m_slots.size() * sizeof(uint64_t));
+  payload.append(writer.m_strings);
+  header.checksum = Fnv1a(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+
+  const std::string tempPath = path + ".tmp";
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      kodi::Log(ADDON_LOG_WARNING, "Snapshot: cannot write %s", tempPath.c_str());
+      return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!out.flush()) {
+      kodi::Log(ADDON_LOG_WARNING, "Snapshot: write to %s failed", tempPath.c_str());
+      std::remove(tempPath.c_str());
+      return false;
+    }
+  }
+#ifdef _WIN32
+  std::remove(path.c_str());  // rename() does not replace on Windows
+#endif
+  if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+    kodi::Log(ADDON_LOG_WARNING, "Snapshot: cannot replace %s", path.c_str());
+    std::remove(tempPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool Snapshot::Load(const std::string& path, Data& data) {
+  MappedFile file(path);
+  if (!file.Data()) return false;
+
+  if (file.Size() < sizeof(Header)) return false;
+  Header header;
+  std::memcpy(&header, file.Data(), sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+    kodi::Log(ADDON_LOG_INFO, "Snapshot: %s is from another version, ignoring", path.c_str());
+    return false;
+  }
+  if (header.fileSize != file.Size() || header.stringsOffset > header.fileSize ||
+      header.stringsSize != header.fileSize - header.stringsOffset ||
+      header.sectionCount > SECTION_COUNT ||
+      sizeof(Header) + header.sectionCount * sizeof(SectionEntry) > header.stringsOffset) {
+    kodi::Log(ADDON_LOG_WARNING, "Snapshot: %s is truncated or malformed, ignoring", path.c_str());
+    return false;
+  }
+  if (Fnv1a(file.Data() + sizeof(Header), file.Size() - sizeof(Header)) != header.checksum) {
+    kodi::Log(ADDON_LOG_WARNING, "Snapshot: %s fails its checksum, ignoring", path.c_str());
+    return false;
+  }
+
+  const auto* sections = reinterpret_cast<const SectionEntry*>(file.Data() + sizeof(Header));
+  const char* strings = reinterpret_cast<const char*>(file.Data() + header.stringsOffset);
+
+  Data loaded;
+  bool ok = true;
+  for (uint32_t i = 0; i < header.sectionCount && ok; ++i) {
+    const SectionEntry& section = sections[i];
+    uint32_t expectedFields = 0;
+    switch (section.id) {
+      case SECTION_SOURCE: expectedFields = SOURCE_FIELDS; break;
+      case SECTION_PROVIDERS: expectedFields = PROVIDER_FIELDS; break;
+      case SECTION_CHANNELS: expectedFields = CHANNEL_FIELDS; break;
+      case SECTION_TIMER_TYPES: expectedFields = TIMER_TYPE_FIELDS; break;
+      case SECTION_RECORDINGS: expectedFields = RECORDING_FIELDS; break;
+      case SECTION_TIMERS: expectedFields = TIMER_FIELDS; break;
+      default: ok = false; continue;
+    }
+    const uint64_t bytes = section.recordCount * expectedFields * sizeof(uint64_t);
+    if (section.fieldsPerRecord != expectedFields || section.offset % sizeof(uint64_t) != 0 ||
+        section.recordCount > header.stringsOffset || section.offset > header.stringsOffset ||
+        bytes > header.stringsOffset - section.offset) {
+      ok = false;
+      continue;
+    }
+
+    Reader reader(reinterpret_cast<const uint64_t*>(file.Data() + section.offset), strings, header.stringsSize);
+    for (uint64_t r = 0; r < section.recordCount; ++r) {
+      switch (section.id) {
+        case SECTION_SOURCE: VisitSource(loaded.source, reader); break;
+        case SECTION_PROVIDERS: ModelFields::VisitProvider(loaded.providers.emplace_back(), reader); break;
+        case SECTION_CHANNELS: ModelFields::VisitChannel(loaded.channels.emplace_back(), reader); break;
+        case SECTION_TIMER_TYPES: ModelFields::VisitTimerType(loaded.timerTypes.emplace_back(), reader); break;
+        case SECTION_RECORDINGS: ModelFields::VisitRecording(loaded.recordings.emplace_back(), reader); break;
+        case SECTION_TIMERS: ModelFields::VisitTimer(loaded.timers.emplace_back(), reader); break;
+      }
+    }
+    ok = reader.Ok();
+  }
+
+  if (!ok) {
+    kodi::Log(ADDON_LOG_WARNING, "Snapshot: %s has an unexpected layout, ignoring", path.c_str());
+    return false;
+  }
+  data = std::move(loaded);
+  return true;
+}
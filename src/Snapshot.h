@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Models.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Versioned binary warm-start snapshot of the list datasets, written to the
+// addon profile directory after a successful load and served on the next
+// start while the backend is still being reached.
+//
+// Layout (native endianness, everything 8-byte aligned):
+//   Header | SectionEntry[sectionCount] | records | string blob
+// Each record is a fixed number of uint64 slots, one per field in the
+// ModelFields::Visit*() field lists; numbers are stored as-is and strings
+// as (offset << 32 | length) into the blob. Reading is therefore a bounds
+// check plus one copy per field - no parsing - straight out of an mmap of
+// the file. The per-section slot count doubles as a schema check; changing a
+// field's type without changing the count needs a VERSION bump.
+class Snapshot {
+public:
+  static constexpr uint32_t VERSION = 2;
+  static constexpr const char* FILE_NAME = "snapshot.bin";
+
+  struct Data {
+    std::string source;  // backend the data came from; a snapshot of another backend is never served
+    std::vector<UltimateProvider> providers;
+    std::vector<UltimateChannel> channels;
+    std::vector<UltimateTimerType> timerTypes;
+    std::vector<UltimateRecording> recordings;
+    std::vector<UltimateTimer> timers;
+  };
+
+  // Writes to a temporary file and renames it over path, so a crash mid-write
+  // never leaves a torn snapshot behind.
+  static bool Save(const std::string& path, const Data& data);
+
+  // False (with data untouched) if the file is missing, from another
+  // version/schema, truncated or fails its checksum.
+  static bool Load(const std::string& path, Data& data);
+};
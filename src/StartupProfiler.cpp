@@ -0,0 +1,152 @@
+#include "StartupProfiler.h"
+#include "Utils.h"
+#include <kodi/General.h>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+StartupProfiler::StartupProfiler()
+  : m_start(Clock::now()), m_startedAt(std::chrono::system_clock::now()) {}
+
+double StartupProfiler::MsSinceStart(Clock::time_point at) const {
+  return std::chrono::duration<double, std::milli>(at - m_start).count();
+}
+
+StartupProfiler::Phase& StartupProfiler::FindOrAddPhase(const std::string& name) {
+  for (auto& phase : m_phases) {
+    if (phase.name == name) return phase;
+  }
+  m_phases.emplace_back();
+  m_phases.back().name = name;
+  return m_phases.back();
+}
+
+void StartupProfiler::BeginPhase(const std::string& phase) {
+  double now = MsSinceStart(Clock::now());
+  std::lock_guard<std::mutex> lock(m_mutex);
+  FindOrAddPhase(phase).startMs = now;
+}
+
+void StartupProfiler::EndPhase(const std::string& phase, bool ok) {
+  double now = MsSinceStart(Clock::now());
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Phase& entry = FindOrAddPhase(phase);
+  entry.wallMs = now - entry.startMs;
+  entry.ended = true;
+  entry.ok = ok;
+}
+
+void StartupProfiler::Record(const std::string& phase, const LoadStats& stats) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  FindOrAddPhase(phase).providers.push_back(stats);
+}
+
+LoadStatsSink StartupProfiler::SinkFor(const std::string& phase) {
+  return [this, phase](const LoadStats& stats) { Record(phase, stats); };
+}
+
+void StartupProfiler::Finish() {
+  double now = MsSinceStart(Clock::now());
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_finished) return;
+  m_totalMs = now;
+  m_finished = true;
+}
+
+static std::string FormatBytes(uint64_t bytes) {
+  char buffer[32];
+  if (bytes >= 1024 * 1024) {
+    std::snprintf(buffer, sizeof(buffer), "%.1fMB", bytes / (1024.0 * 1024.0));
+  } else if (bytes >= 1024) {
+    std::snprintf(buffer, sizeof(buffer), "%.1fKB", bytes / 1024.0);
+  } else {
+    std::snprintf(buffer, sizeof(buffer), "%lluB", static_cast<unsigned long long>(bytes));
+  }
+  return buffer;
+}
+
+std::string StartupProfiler::Summary() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  char buffer[128];
+  std::snprintf(buffer, sizeof(buffer), "total=%.0fms", m_totalMs);
+  std::string summary = buffer;
+
+  for (const auto& phase : m_phases) {
+    std::snprintf(buffer, sizeof(buffer), " %s=%.0fms", phase.name.c_str(), phase.wallMs);
+    summary += buffer;
+    if (!phase.ended) summary += "(unfinished)";
+    else if (!phase.ok) summary += "(failed)";
+    if (phase.providers.empty()) continue;
+
+    uint64_t bytes = 0;
+    size_t items = 0;
+    double parseMs = 0;
+    const LoadStats* slowest = nullptr;
+    for (const auto& stats : phase.providers) {
+      bytes += stats.bytes;
+      items += stats.items;
+      parseMs += stats.parseMs;
+      if (!slowest || stats.wallMs > slowest->wallMs) slowest = &stats;
+    }
+    std::snprintf(buffer, sizeof(buffer), "/%s/%zu parse=%.0fms", FormatBytes(bytes).c_str(), items, parseMs);
+    summary += buffer;
+    if (phase.providers.size() > 1) {
+      std::snprintf(buffer, sizeof(buffer), " slowest=%s(%.0fms)", slowest->provider.c_str(), slowest->wallMs);
+      summary += buffer;
+    }
+  }
+  return summary;
+}
+
+nlohmann::json StartupProfiler::ToJson(const std::string& addonVersion) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  nlohmann::json report;
+  report["version"] = VERSION;
+  report["addonVersion"] = addonVersion;
+  report["startedAt"] = Utils::ToISO8601(std::chrono::system_clock::to_time_t(m_startedAt));
+  report["totalMs"] = m_totalMs;
+
+  nlohmann::json phases = nlohmann::json::array();
+  for (const auto& phase : m_phases) {
+    nlohmann::json providers = nlohmann::json::array();
+    uint64_t bytes = 0;
+    size_t items = 0;
+    double parseMs = 0;
+    for (const auto& stats : phase.providers) {
+      bytes += stats.bytes;
+      items += stats.items;
+      parseMs += stats.parseMs;
+      providers.push_back({
+        {"provider", stats.provider},
+        {"ok", stats.ok},
+        {"notModified", stats.notModified},
+        {"wallMs", stats.wallMs},
+        {"bytes", stats.bytes},
+        {"items", stats.items},
+        {"parseMs", stats.parseMs},
+      });
+    }
+    phases.push_back({
+      {"name", phase.name},
+      {"ok", phase.ended && phase.ok},
+      {"startMs", phase.startMs},
+      {"wallMs", phase.wallMs},
+      {"bytes", bytes},
+      {"items", items},
+      {"parseMs", parseMs},
+      {"providers", std::move(providers)},
+    });
+  }
+  report["phases"] = std::move(phases);
+  return report;
+}
+
+bool StartupProfiler::Save(const std::string& path, const std::string& addonVersion) const {
+  std::string content = ToJson(addonVersion).dump(2);
+  std::ofstream out(path, std::ios::trunc);
+  if (!out || !(out << content << '\n')) {
+    kodi::Log(ADDON_LOG_WARNING, "Startup profile: failed to write %s", path.c_str());
+    return false;
+  }
+  return true;
+}
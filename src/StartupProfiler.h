@@ -0,0 +1,67 @@
+#pragma once
+
+#include "LoadStats.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Wall-time breakdown of one InitializeAsync run: each phase (backend probe,
+// snapshot restore, the per-dataset loads) with the per-provider LoadStats
+// reported into it. Phases run side by side on the startup TaskGraph and
+// providers on the fan-out threads, so every method is thread-safe.
+//
+// The report is logged as one line (Summary) and written as JSON (ToJson)
+// to FILE_NAME in the addon profile directory, overwritten on every start,
+// so startup regressions can be compared across releases.
+class StartupProfiler {
+public:
+  static constexpr int VERSION = 1;
+  static constexpr const char* FILE_NAME = "startup_profile.json";
+
+  StartupProfiler();
+
+  // Phases are keyed by name. Ending a phase that was never begun records it
+  // as starting when the profiler was created.
+  void BeginPhase(const std::string& phase);
+  void EndPhase(const std::string& phase, bool ok = true);
+
+  // Adds one provider's (or one request's) cost to a phase.
+  void Record(const std::string& phase, const LoadStats& stats);
+  LoadStatsSink SinkFor(const std::string& phase);
+
+  // Total run time; stops the clock for Summary/ToJson on the first call.
+  void Finish();
+
+  // "total=812ms probe=35ms providers=20ms/1.2KB/6 parse=1ms
+  // channels=640ms/4.2MB/18000 parse=210ms slowest=foo(590ms) ...", phases
+  // in the order they were first seen.
+  std::string Summary() const;
+  nlohmann::json ToJson(const std::string& addonVersion) const;
+
+  // Writes ToJson() to path (a native path), replacing the previous report.
+  bool Save(const std::string& path, const std::string& addonVersion) const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Phase {
+    std::string name;
+    double startMs = 0;
+    double wallMs = 0;
+    bool ended = false;
+    bool ok = false;
+    std::vector<LoadStats> providers;
+  };
+
+  Phase& FindOrAddPhase(const std::string& name);
+  double MsSinceStart(Clock::time_point at) const;
+
+  Clock::time_point m_start;
+  std::chrono::system_clock::time_point m_startedAt;
+  double m_totalMs = 0;
+  bool m_finished = false;
+  std::vector<Phase> m_phases;  // in BeginPhase order; a handful, linear lookup
+  mutable std::mutex m_mutex;
+};
@@ -0,0 +1,79 @@
+#include "TaskGraph.h"
+#include <kodi/General.h>
+#include <thread>
+#include <chrono>
+#include <sstream>
+#include <exception>
+
+TaskGraph::TaskId TaskGraph::Add(const std::string& name, std::function<void()> fn,
+                                 const std::vector<TaskId>& dependsOn) {
+  Task task;
+  task.name = name;
+  task.fn = std::move(fn);
+  for (TaskId dependency : dependsOn) {
+    if (dependency < m_tasks.size()) task.dependsOn.push_back(dependency);
+  }
+  m_tasks.push_back(std::move(task));
+  return m_tasks.size() - 1;
+}
+
+void TaskGraph::Run(const std::function<bool()>& cancelled) {
+  const auto start = std::chrono::steady_clock::now();
+  auto elapsedMs = [start]() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  auto runTask = [this, &cancelled, &elapsedMs](TaskId id) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this, id]() {
+        for (TaskId dependency : m_tasks[id].dependsOn) {
+          if (!m_tasks[dependency].finished) return false;
+        }
+        return true;
+      });
+      m_tasks[id].startMs = elapsedMs();
+    }
+
+    bool skipped = cancelled && cancelled();
+    if (!skipped) {
+      try {
+        m_tasks[id].fn();
+      } catch (const std::exception& e) {
+        kodi::Log(ADDON_LOG_ERROR, "Startup task '%s' failed: %s", m_tasks[id].name.c_str(), e.what());
+      } catch (...) {
+        kodi::Log(ADDON_LOG_ERROR, "Startup task '%s' failed: unknown exception", m_tasks[id].name.c_str());
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks[id].finished = true;
+      m_tasks[id].skipped = skipped;
+      m_tasks[id].endMs = elapsedMs();
+    }
+    m_cv.notify_all();
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(m_tasks.size());
+  for (TaskId id = 0; id < m_tasks.size(); ++id) {
+    threads.emplace_back(runTask, id);
+  }
+  for (auto& thread : threads) thread.join();
+}
+
+std::string TaskGraph::Summary() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::ostringstream summary;
+  summary.setf(std::ios::fixed);
+  summary.precision(0);
+  for (size_t i = 0; i < m_tasks.size(); ++i) {
+    const Task& task = m_tasks[i];
+    if (i > 0) summary << ", ";
+    summary << task.name << " ";
+    if (task.skipped) summary << "skipped";
+    else summary << task.startMs << "-" << task.endMs << " ms";
+  }
+  return summary.str();
+}
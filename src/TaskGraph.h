@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+// Minimal dependency graph for InitializeAsync: every task runs on its own
+// thread as soon as all tasks it depends on have finished, so independent
+// loads overlap while e.g. channels still wait for providers.
+class TaskGraph {
+public:
+  using TaskId = size_t;
+
+  // Dependencies must already have been added (ids are handed out in order),
+  // which also rules out cycles.
+  TaskId Add(const std::string& name, std::function<void()> fn, const std::vector<TaskId>& dependsOn = {});
+
+  // Runs all tasks and returns when every one has finished or been skipped.
+  // Once cancelled() returns true, tasks that have not started yet are
+  // skipped (running ones are expected to check for cancellation themselves).
+  // An exception from a task is logged and counts as that task finishing.
+  void Run(const std::function<bool()>& cancelled);
+
+  // Per-task wall time relative to the start of Run(), for the startup log:
+  // "name start-end ms, ..." in the order tasks were added.
+  std::string Summary() const;
+
+private:
+  struct Task {
+    std::string name;
+    std::function<void()> fn;
+    std::vector<TaskId> dependsOn;
+    bool finished = false;
+    bool skipped = false;
+    double startMs = 0;
+    double endMs = 0;
+  };
+
+  std::vector<Task> m_tasks;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+};
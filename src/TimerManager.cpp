@@ -1,15 +1,31 @@
 #include "TimerManager.h"
 #include "Utils.h"
+#include "ModelFields.h"
+#include "DeltaSync.h"
+#include "JsonFieldTable.h"
+#include <array>
 
 bool TimerManager::LoadTimerTypes(const std::vector<UltimateProvider>& providers,
                                   const std::function<std::string(const std::string&)>& httpGet,
-                                  const std::function<bool(const std::string&, nlohmann::json&)>& parseJson) {
+                                  const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                                  const FanOutExecutor& executor,
+                                  const LoadStatsSink& onStats) {
   std::vector<UltimateTimerType> newTimerTypes;
 
-  for (const auto& provider : providers) {
-    if (provider.enabled) {
-      LoadTimerTypesForProvider(provider.name, httpGet, parseJson, newTimerTypes);
+  std::vector<std::vector<UltimateTimerType>> perProvider(providers.size());
+  executor.Run(providers.size(), [&](size_t i) {
+    if (!providers[i].enabled) return;
+    auto start = LoadStats::Clock::now();
+    LoadStats stats;
+    stats.provider = providers[i].name;
+    stats.ok = LoadTimerTypesForProvider(providers[i].name, httpGet, parseJson, perProvider[i], stats);
+    if (onStats) {
+      stats.wallMs = LoadStats::MsSince(start);
+      onStats(stats);
     }
+  });
+  for (auto& timerTypes : perProvider) {
+    newTimerTypes.insert(newTimerTypes.end(), timerTypes.begin(), timerTypes.end());
   }
 
   if (newTimerTypes.empty()) {
@@ -20,22 +36,28 @@ bool TimerManager::LoadTimerTypes(const std::vector<UltimateProvider>& providers
     newTimerTypes.push_back(manual);
   }
 
-  std::unique_lock<std::shared_mutex> lock(m_dataMutex);
-  m_timerTypes = std::move(newTimerTypes);
-
+  auto data = std::make_shared<TimerTypesData>();
+  data->fingerprint = ModelFields::Fingerprint(newTimerTypes, [](const UltimateTimerType& timerType, auto& v) {
+    ModelFields::VisitTimerType(timerType, v);
+  });
+  data->timerTypes = std::move(newTimerTypes);
+  m_timerTypes.Store(std::move(data));
   return true;
 }
 
-void TimerManager::LoadTimerTypesForProvider(const std::string& provider,
+bool TimerManager::LoadTimerTypesForProvider(const std::string& provider,
                                              const std::function<std::string(const std::string&)>& httpGet,
                                              const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                             std::vector<UltimateTimerType>& outTimerTypes) {
+                                             std::vector<UltimateTimerType>& outTimerTypes,
+                                             LoadStats& stats) {
   std::string response = httpGet("/api/providers/" + Utils::UrlPathEncode(provider) + "/timer-types");
-  if (response.empty()) return;
+  if (response.empty()) return false;
+  stats.bytes = response.size();
+  auto parseStart = LoadStats::Clock::now();
 
   nlohmann::json document;
-  if (!parseJson(response, document)) return;
-  if (!document.contains("timer_types") || !document["timer_types"].is_array()) return;
+  if (!parseJson(response, document)) return false;
+  if (!document.contains("timer_types") || !document["timer_types"].is_array()) return false;
 
   for (const auto& ttJson : document["timer_types"]) {
     UltimateTimerType timerType;
@@ -45,118 +67,214 @@ void TimerManager::LoadTimerTypesForProvider(const std::string& provider,
     timerType.priority = (ttJson.contains("priority") && ttJson["priority"].is_number_integer()) ? ttJson["priority"].get<int>() : 50;
     outTimerTypes.push_back(timerType);
   }
+  stats.items = outTimerTypes.size();
+  stats.parseMs = LoadStats::MsSince(parseStart);
+  return true;
 }
 
 bool TimerManager::LoadTimers(const std::vector<UltimateProvider>& providers,
-                              const std::function<std::string(const std::string&)>& httpGet,
-                              const std::function<bool(const std::string&, nlohmann::json&)>& parseJson) {
-  std::vector<UltimateTimer> newTimers;
-
-  for (const auto& provider : providers) {
-    if (provider.enabled) {
-      LoadTimersForProvider(provider.name, httpGet, parseJson, newTimers);
+                              const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                              const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                              const FanOutExecutor& executor,
+                              const LoadStatsSink& onStats) {
+  std::lock_guard<std::mutex> loadLock(m_loadMutex);
+  std::shared_ptr<const TimersData> heldData = m_timers.Load();
+  const std::set<std::string>& loadedProviders = heldData->loadedProviders;
+  const std::map<std::string, std::string>& cursors = heldData->cursors;
+
+  std::vector<ProviderTimers> perProvider(providers.size());
+  std::vector<char> loaded(providers.size(), 0);
+
+  executor.Run(providers.size(), [&](size_t i) {
+    if (!providers[i].enabled) return;
+    const std::string& provider = providers[i].name;
+    // A cursor only means something relative to timers we still hold.
+    bool held = loadedProviders.contains(provider);
+    auto cursor = cursors.find(provider);
+    std::string since = (held && cursor != cursors.end()) ? cursor->second : "";
+
+    ProviderTimers& result = perProvider[i];
+    auto start = LoadStats::Clock::now();
+    LoadStats stats;
+    stats.provider = provider;
+    stats.ok = LoadTimersForProvider(provider, held, since, httpGet, parseJson, result, stats);
+    if (onStats) {
+      stats.notModified = result.notModified;
+      stats.wallMs = LoadStats::MsSince(start);
+      onStats(stats);
     }
+    if (!stats.ok) {
+      // A failed request keeps what is held for the provider (see
+      // ChannelManager::LoadChannels), cursor included.
+      if (!held) return;
+      result = ProviderTimers();
+      result.notModified = true;
+    }
+    if (result.notModified || result.delta) {
+      std::vector<UltimateTimer> current;
+      ReuseProviderTimers(*heldData, provider, current);
+      if (result.delta) {
+        DeltaSync::Apply(current, std::move(result.timers), result.removedIndexes,
+                         [](const UltimateTimer& timer) { return timer.clientIndex; });
+      }
+      result.timers = std::move(current);
+    }
+    if (result.notModified) result.cursor = since;
+    loaded[i] = 1;
+  });
+
+  auto data = std::make_shared<TimersData>();
+  size_t deltaProviders = 0;
+  for (size_t i = 0; i < providers.size(); ++i) {
+    if (!loaded[i]) continue;
+    ProviderTimers& result = perProvider[i];
+    data->timers.insert(data->timers.end(), std::make_move_iterator(result.timers.begin()),
+                        std::make_move_iterator(result.timers.end()));
+    data->loadedProviders.insert(providers[i].name);
+    if (!result.cursor.empty()) data->cursors[providers[i].name] = std::move(result.cursor);
+    if (result.delta) deltaProviders++;
+  }
+  if (deltaProviders > 0) {
+    kodi::Log(ADDON_LOG_DEBUG, "Timers: %zu of %zu providers delta-synced", deltaProviders,
+              data->loadedProviders.size());
   }
 
-  std::unique_lock<std::shared_mutex> lock(m_dataMutex);
-  m_timers = std::move(newTimers);
-
+  data->fingerprint = ModelFields::Fingerprint(data->timers, [](const UltimateTimer& timer, auto& v) {
+    ModelFields::VisitTimer(timer, v);
+  });
+  m_timers.Store(std::move(data));
   return true;
 }
 
-void TimerManager::LoadTimersForProvider(const std::string& provider,
-                                         const std::function<std::string(const std::string&)>& httpGet,
+void TimerManager::ReuseProviderTimers(const TimersData& held, const std::string& provider,
+                                       std::vector<UltimateTimer>& outTimers) {
+  for (const auto& timer : held.timers) {
+    if (timer.provider == provider) outTimers.push_back(timer);
+  }
+}
+
+bool TimerManager::LoadTimersForProvider(const std::string& provider, bool conditional, const std::string& since,
+                                         const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
                                          const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                         std::vector<UltimateTimer>& outTimers) {
-  std::string response = httpGet("/api/providers/" + Utils::UrlPathEncode(provider) + "/timers?include_inactive=true");
-  if (response.empty()) return;
+                                         ProviderTimers& out, LoadStats& stats) {
+  std::string url = DeltaSync::AppendSince(
+      "/api/providers/" + Utils::UrlPathEncode(provider) + "/timers?include_inactive=true", since);
+  // Delta URLs are one-off, there is nothing to revalidate.
+  std::string response = httpGet(url, conditional && since.empty(), out.notModified);
+  if (out.notModified) return true;
+  if (response.empty()) return false;
+  stats.bytes = response.size();
+  auto parseStart = LoadStats::Clock::now();
 
   nlohmann::json document;
-  if (!parseJson(response, document)) return;
-  if (!document.contains("timers") || !document["timers"].is_array()) return;
+  if (!parseJson(response, document)) return false;
+  if (!document.contains("timers") || !document["timers"].is_array()) return false;
+
+  out.delta = !since.empty() && document.contains("delta") && document["delta"].is_boolean() &&
+              document["delta"].get<bool>();
+  out.cursor = (document.contains("cursor") && document["cursor"].is_string()) ? document["cursor"].get<std::string>() : "";
+  if (out.delta && document.contains("removed") && document["removed"].is_array()) {
+    for (const auto& index : document["removed"]) {
+      if (index.is_number_integer()) out.removedIndexes.push_back(index.get<int>());
+    }
+  }
 
-  for (const auto& timerJson : document["timers"]) {
+  for (auto& timerJson : document["timers"]) {
     UltimateTimer timer;
-    timer.provider = provider;
+    if (ParseTimer(timerJson, provider, timer)) out.timers.push_back(std::move(timer));
+  }
+  stats.items = out.timers.size();
+  stats.parseMs = LoadStats::MsSince(parseStart);
+  return true;
+}
 
-    if (timerJson.contains("client_index") && timerJson["client_index"].is_number_integer())
-      timer.clientIndex = timerJson["client_index"].get<int>();
-    else continue;
+// Members of a timer entry that only feed derived UltimateTimer fields.
+struct DecodedTimer : UltimateTimer {
+  bool hasClientIndex = false;
+};
 
-    if (timerJson.contains("timer_type_id") && timerJson["timer_type_id"].is_number_integer())
-      timer.timerTypeId = timerJson["timer_type_id"].get<int>();
-    if (timerJson.contains("title") && timerJson["title"].is_string())
-      timer.title = timerJson["title"].get<std::string>();
-    if (timerJson.contains("parent_client_index") && timerJson["parent_client_index"].is_number_integer())
-      timer.parentClientIndex = timerJson["parent_client_index"].get<int>();
-
-    if (timerJson.contains("client_channel_uid") && timerJson["client_channel_uid"].is_number_integer())
-      timer.clientChannelUid = timerJson["client_channel_uid"].get<int>();
-    if (timerJson.contains("channel_name") && timerJson["channel_name"].is_string())
-      timer.channelName = timerJson["channel_name"].get<std::string>();
-
-    if (timerJson.contains("start_time") && timerJson["start_time"].is_string())
-      timer.startTime = Utils::ParseISO8601(timerJson["start_time"].get<std::string>());
-    if (timerJson.contains("end_time") && timerJson["end_time"].is_string())
-      timer.endTime = Utils::ParseISO8601(timerJson["end_time"].get<std::string>());
-    if (timerJson.contains("start_any_time") && timerJson["start_any_time"].is_boolean())
-      timer.startAnyTime = timerJson["start_any_time"].get<bool>();
-    if (timerJson.contains("end_any_time") && timerJson["end_any_time"].is_boolean())
-      timer.endAnyTime = timerJson["end_any_time"].get<bool>();
-
-    if (timerJson.contains("margin_start") && timerJson["margin_start"].is_number_integer())
-      timer.marginStart = timerJson["margin_start"].get<int>();
-    if (timerJson.contains("margin_end") && timerJson["margin_end"].is_number_integer())
-      timer.marginEnd = timerJson["margin_end"].get<int>();
-
-    if (timerJson.contains("state") && timerJson["state"].is_number_integer())
-      timer.state = timerJson["state"].get<int>();
-
-    if (timerJson.contains("weekdays") && timerJson["weekdays"].is_number_integer())
-      timer.weekdays = timerJson["weekdays"].get<int>();
-    if (timerJson.contains("first_day") && timerJson["first_day"].is_string())
-      timer.firstDay = Utils::ParseISO8601(timerJson["first_day"].get<std::string>());
-
-    if (timerJson.contains("prevent_duplicate_episodes") && timerJson["prevent_duplicate_episodes"].is_number_integer())
-      timer.preventDuplicateEpisodes = timerJson["prevent_duplicate_episodes"].get<int>();
-    if (timerJson.contains("series_link") && timerJson["series_link"].is_string())
-      timer.seriesLink = timerJson["series_link"].get<std::string>();
-
-    if (timerJson.contains("directory") && timerJson["directory"].is_string())
-      timer.directory = timerJson["directory"].get<std::string>();
-    if (timerJson.contains("priority") && timerJson["priority"].is_number_integer())
-      timer.priority = timerJson["priority"].get<int>();
-    if (timerJson.contains("lifetime") && timerJson["lifetime"].is_number_integer())
-      timer.lifetime = timerJson["lifetime"].get<int>();
-    if (timerJson.contains("max_recordings") && timerJson["max_recordings"].is_number_integer())
-      timer.maxRecordings = timerJson["max_recordings"].get<int>();
-    if (timerJson.contains("recording_group") && timerJson["recording_group"].is_number_integer())
-      timer.recordingGroup = timerJson["recording_group"].get<int>();
-
-    if (timerJson.contains("epg_search_string") && timerJson["epg_search_string"].is_string())
-      timer.epgSearchString = timerJson["epg_search_string"].get<std::string>();
-    if (timerJson.contains("full_text_epg_search") && timerJson["full_text_epg_search"].is_boolean())
-      timer.fullTextEpgSearch = timerJson["full_text_epg_search"].get<bool>();
-    if (timerJson.contains("epg_uid") && timerJson["epg_uid"].is_number_integer())
-      timer.epgUid = timerJson["epg_uid"].get<int>();
-    if (timerJson.contains("epg_event_id") && timerJson["epg_event_id"].is_string())
-      timer.epgEventId = timerJson["epg_event_id"].get<std::string>();
-
-    if (timerJson.contains("genre_type") && timerJson["genre_type"].is_number_integer())
-      timer.genreType = timerJson["genre_type"].get<int>();
-    if (timerJson.contains("genre_sub_type") && timerJson["genre_sub_type"].is_number_integer())
-      timer.genreSubType = timerJson["genre_sub_type"].get<int>();
-
-    if (timerJson.contains("description") && timerJson["description"].is_string())
-      timer.description = timerJson["description"].get<std::string>();
-
-    outTimers.push_back(timer);
-  }
+using TimerField = JsonFieldTable::Fields<DecodedTimer>;
+static constexpr auto TIMER_FIELDS = JsonFieldTable::Sorted(std::array{
+  TimerField::Custom("client_index", JsonFieldTable::Type::INTEGER, [](nlohmann::json& value, DecodedTimer& out) {
+    out.hasClientIndex = true;
+    out.clientIndex = value.get<int>();
+  }),
+  TimerField::Integer<&UltimateTimer::timerTypeId>("timer_type_id"),
+  TimerField::String<&UltimateTimer::title>("title"),
+  TimerField::Integer<&UltimateTimer::parentClientIndex>("parent_client_index"),
+
+  TimerField::Integer<&UltimateTimer::clientChannelUid>("client_channel_uid"),
+  TimerField::String<&UltimateTimer::channelName>("channel_name"),
+
+  TimerField::Time<&UltimateTimer::startTime>("start_time"),
+  TimerField::Time<&UltimateTimer::endTime>("end_time"),
+  TimerField::Boolean<&UltimateTimer::startAnyTime>("start_any_time"),
+  TimerField::Boolean<&UltimateTimer::endAnyTime>("end_any_time"),
+
+  TimerField::Integer<&UltimateTimer::marginStart>("margin_start"),
+  TimerField::Integer<&UltimateTimer::marginEnd>("margin_end"),
+
+  TimerField::Integer<&UltimateTimer::state>("state"),
+
+  TimerField::Integer<&UltimateTimer::weekdays>("weekdays"),
+  TimerField::Time<&UltimateTimer::firstDay>("first_day"),
+
+  TimerField::Integer<&UltimateTimer::preventDuplicateEpisodes>("prevent_duplicate_episodes"),
+  TimerField::String<&UltimateTimer::seriesLink>("series_link"),
+
+  TimerField::String<&UltimateTimer::directory>("directory"),
+  TimerField::Integer<&UltimateTimer::priority>("priority"),
+  TimerField::Integer<&UltimateTimer::lifetime>("lifetime"),
+  TimerField::Integer<&UltimateTimer::maxRecordings>("max_recordings"),
+  TimerField::Integer<&UltimateTimer::recordingGroup>("recording_group"),
+
+  TimerField::String<&UltimateTimer::epgSearchString>("epg_search_string"),
+  TimerField::Boolean<&UltimateTimer::fullTextEpgSearch>("full_text_epg_search"),
+  TimerField::Integer<&UltimateTimer::epgUid>("epg_uid"),
+  TimerField::String<&UltimateTimer::epgEventId>("epg_event_id"),
+
+  TimerField::Integer<&UltimateTimer::genreType>("genre_type"),
+  TimerField::Integer<&UltimateTimer::genreSubType>("genre_sub_type"),
+
+  TimerField::String<&UltimateTimer::description>("description"),
+});
+
+bool TimerManager::ParseTimer(nlohmann::json& timerJson, const std::string& provider, UltimateTimer& timer) {
+  DecodedTimer decoded;
+  JsonFieldTable::Decode(timerJson, TIMER_FIELDS, decoded);
+  if (!decoded.hasClientIndex) return false;
+
+  timer = std::move(static_cast<UltimateTimer&>(decoded));
+  timer.provider = provider;
+  return true;
+}
+
+void TimerManager::RestoreTimerTypes(std::vector<UltimateTimerType> timerTypes) {
+  auto data = std::make_shared<TimerTypesData>();
+  data->fingerprint = ModelFields::Fingerprint(timerTypes, [](const UltimateTimerType& timerType, auto& v) {
+    ModelFields::VisitTimerType(timerType, v);
+  });
+  data->timerTypes = std::move(timerTypes);
+  m_timerTypes.Store(std::move(data));
+}
+
+void TimerManager::RestoreTimers(std::vector<UltimateTimer> timers) {
+  auto data = std::make_shared<TimersData>();
+  data->fingerprint = ModelFields::Fingerprint(timers, [](const UltimateTimer& timer, auto& v) {
+    ModelFields::VisitTimer(timer, v);
+  });
+  data->timers = std::move(timers);
+  m_timers.Store(std::move(data));
+}
+
+uint64_t TimerManager::GetFingerprint() const {
+  // Asymmetric combination, so a change to either one changes the result.
+  return m_timerTypes.Load()->fingerprint ^ (m_timers.Load()->fingerprint * 0x9e3779b97f4a7c15ull);
 }
 
 bool TimerManager::GetTimerTypes(std::vector<kodi::addon::PVRTimerType>& types) const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  for (const auto& timerType : m_timerTypes) {
+  auto data = m_timerTypes.Load();
+  for (const auto& timerType : data->timerTypes) {
     kodi::addon::PVRTimerType type;
     type.SetId(timerType.id);
     type.SetDescription(timerType.description);
@@ -181,13 +299,12 @@ bool TimerManager::GetTimerTypes(std::vector<kodi::addon::PVRTimerType>& types)
 }
 
 int TimerManager::GetTimersAmount() const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  return static_cast<int>(m_timers.size());
+  return static_cast<int>(m_timers.Load()->timers.size());
 }
 
 bool TimerManager::GetTimers(kodi::addon::PVRTimersResultSet& results) const {
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  for (const auto& timer : m_timers) {
+  auto data = m_timers.Load();
+  for (const auto& timer : data->timers) {
     kodi::addon::PVRTimer kodiTimer;
     MapTimerToKodi(timer, kodiTimer);
     results.Add(kodiTimer);
@@ -289,7 +406,7 @@ PVR_TIMER_STATE TimerManager::MapTimerStateToKodi(int state) {
 
 bool TimerManager::AddTimer(const kodi::addon::PVRTimer& timer,
                             const std::vector<UltimateProvider>& providers,
-                            const std::map<int, ChannelLookupInfo>& channelLookup,
+                            const std::function<bool(int, ChannelView&)>& getChannelByUid,
                             const std::function<std::string(const std::string&)>& buildApiUrl,
                             const std::function<bool(const std::string&, const std::string&)>& httpPost,
                             const std::function<void()>& loadTimers) {
@@ -298,9 +415,9 @@ bool TimerManager::AddTimer(const kodi::addon::PVRTimer& timer,
 
   std::string provider;
 
-  if (timer.GetClientChannelUid() > 0) {
-    auto it = channelLookup.find(timer.GetClientChannelUid());
-    if (it != channelLookup.end()) provider = it->second.provider;
+  ChannelView channel;
+  if (timer.GetClientChannelUid() > 0 && getChannelByUid(timer.GetClientChannelUid(), channel)) {
+    provider = channel.Provider();
   }
   if (provider.empty() && !providers.empty()) {
     provider = providers[0].name;
@@ -347,18 +464,13 @@ bool TimerManager::DeleteTimer(int clientIndex, bool forceDelete,
                                const std::function<bool(const std::string&)>& httpDelete,
                                const std::function<void()>& loadTimers) {
   std::string provider;
-  bool found = false;
-
   {
-    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-    UltimateTimer* ultimateTimer = FindTimer(clientIndex);
+    auto data = m_timers.Load();
+    const UltimateTimer* ultimateTimer = FindTimer(*data, clientIndex);
     if (!ultimateTimer) return false;
     provider = ultimateTimer->provider;
-    found = true;
   }
 
-  if (!found) return false;
-
   std::string url = buildApiUrl("/api/providers/" + Utils::UrlPathEncode(provider) + "/timers/" + std::to_string(clientIndex));
   if (forceDelete) url += "?force=true";
 
@@ -374,14 +486,14 @@ bool TimerManager::UpdateTimer(const kodi::addon::PVRTimer& timer,
                                const std::function<void()>& loadTimers) {
   int clientIndex = timer.GetClientIndex();
 
-  std::shared_lock<std::shared_mutex> lock(m_dataMutex);
-  UltimateTimer* existingTimer = FindTimer(clientIndex);
-  if (!existingTimer) return false;
-
   UltimateTimer updatedTimer;
-  MapKodiTimerToUltimate(timer, updatedTimer);
-  updatedTimer.provider = existingTimer->provider;
-  lock.unlock();
+  {
+    auto data = m_timers.Load();
+    const UltimateTimer* existingTimer = FindTimer(*data, clientIndex);
+    if (!existingTimer) return false;
+    MapKodiTimerToUltimate(timer, updatedTimer);
+    updatedTimer.provider = existingTimer->provider;
+  }
 
   nlohmann::json doc = nlohmann::json::object();
   doc["timer_type_id"] = updatedTimer.timerTypeId;
@@ -417,8 +529,8 @@ bool TimerManager::UpdateTimer(const kodi::addon::PVRTimer& timer,
   return true;
 }
 
-UltimateTimer* TimerManager::FindTimer(int clientIndex) {
-  for (auto& timer : m_timers) {
+const UltimateTimer* TimerManager::FindTimer(const TimersData& data, int clientIndex) {
+  for (const auto& timer : data.timers) {
     if (timer.clientIndex == clientIndex) return &timer;
   }
   return nullptr;
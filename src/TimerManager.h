@@ -1,10 +1,15 @@
 #pragma once
 
 #include "Models.h"
+#include "FanOutExecutor.h"
+#include "LoadStats.h"
+#include "AtomicSharedPtr.h"
+#include "ChannelStore.h"
 #include <kodi/addon-instance/PVR.h>
 #include <vector>
 #include <map>
-#include <shared_mutex>
+#include <set>
+#include <memory>
 #include <mutex>
 #include <functional>
 #include <string>
@@ -12,15 +17,47 @@
 
 class TimerManager {
 public:
+  // Immutable views of the held timer types and timers. They load on their
+  // own schedules, so each is published separately (see AtomicSharedPtr).
+  struct TimerTypesData {
+    std::vector<UltimateTimerType> timerTypes;
+    uint64_t fingerprint = 0;
+  };
+  struct TimersData {
+    std::vector<UltimateTimer> timers;
+    std::set<std::string> loadedProviders;  // providers whose timers came from a usable response
+    std::map<std::string, std::string> cursors;  // provider -> delta-sync cursor of its last response
+    uint64_t fingerprint = 0;
+  };
+
   TimerManager() = default;
 
+  // Both loads fetch providers in parallel on executor and merge the
+  // results in providers order. onStats, if set, receives each enabled
+  // provider's LoadStats.
   bool LoadTimerTypes(const std::vector<UltimateProvider>& providers,
                       const std::function<std::string(const std::string&)>& httpGet,
-                      const std::function<bool(const std::string&, nlohmann::json&)>& parseJson);
-
+                      const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                      const FanOutExecutor& executor,
+                      const LoadStatsSink& onStats = nullptr);
+
+  // httpGet has the conditional-GET contract described at
+  // ProviderManager::LoadProviders, so the reload after a timer mutation only
+  // re-parses providers whose timer list actually changed - and only the
+  // changed timers when the backend supports delta sync (see DeltaSync.h).
   bool LoadTimers(const std::vector<UltimateProvider>& providers,
-                  const std::function<std::string(const std::string&)>& httpGet,
-                  const std::function<bool(const std::string&, nlohmann::json&)>& parseJson);
+                  const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
+                  const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
+                  const FanOutExecutor& executor,
+                  const LoadStatsSink& onStats = nullptr);
+
+  // Serve timer types and timers from a warm-start snapshot until the next load.
+  void RestoreTimerTypes(std::vector<UltimateTimerType> timerTypes);
+  void RestoreTimers(std::vector<UltimateTimer> timers);
+
+  // Content fingerprint of the held timer types and timers together
+  // (ModelFields::Fingerprint) - Kodi re-reads both on a timer update.
+  uint64_t GetFingerprint() const;
 
   bool GetTimerTypes(std::vector<kodi::addon::PVRTimerType>& types) const;
   int GetTimersAmount() const;
@@ -28,7 +65,7 @@ public:
 
   static bool AddTimer(const kodi::addon::PVRTimer& timer,
                        const std::vector<UltimateProvider>& providers,
-                       const std::map<int, ChannelLookupInfo>& channelLookup,
+                       const std::function<bool(int, ChannelView&)>& getChannelByUid,
                        const std::function<std::string(const std::string&)>& buildApiUrl,
                        const std::function<bool(const std::string&, const std::string&)>& httpPost,
                        const std::function<void()>& loadTimers);
@@ -43,25 +80,41 @@ public:
                    const std::function<bool(const std::string&, const std::string&)>& httpPut,
                    const std::function<void()>& loadTimers);
 
-  UltimateTimer* FindTimer(int clientIndex);
-  const std::vector<UltimateTimer>& GetTimers() const { return m_timers; }
-  const std::vector<UltimateTimerType>& GetTimerTypes() const { return m_timerTypes; }
-
-  void LockShared() const { m_dataMutex.lock_shared(); }
-  void UnlockShared() const { m_dataMutex.unlock_shared(); }
-  void LockUnique() const { m_dataMutex.lock(); }
-  void UnlockUnique() const { m_dataMutex.unlock(); }
+  static const UltimateTimer* FindTimer(const TimersData& data, int clientIndex);
+  std::shared_ptr<const TimerTypesData> GetTimerTypesData() const { return m_timerTypes.Load(); }
+  std::shared_ptr<const TimersData> GetTimersData() const { return m_timers.Load(); }
 
 private:
-  static void LoadTimerTypesForProvider(const std::string& provider,
+  // Returns true if the provider's timer types were loaded.
+  static bool LoadTimerTypesForProvider(const std::string& provider,
                                         const std::function<std::string(const std::string&)>& httpGet,
                                         const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                        std::vector<UltimateTimerType>& outTimerTypes);
-
-  static void LoadTimersForProvider(const std::string& provider,
-                                    const std::function<std::string(const std::string&)>& httpGet,
+                                        std::vector<UltimateTimerType>& outTimerTypes,
+                                        LoadStats& stats);
+
+  // One provider's load result. With delta set, timers holds only the
+  // added/changed entries relative to what is held for the provider.
+  struct ProviderTimers {
+    bool notModified = false;
+    bool delta = false;
+    std::vector<UltimateTimer> timers;
+    std::vector<int> removedIndexes;
+    std::string cursor;  // for the next delta request, "" if the backend has none
+  };
+
+  // Returns true if the provider's timers were loaded (or, with notModified
+  // set, are unchanged and nothing was added to the output). since is the
+  // provider's delta cursor, "" for a full load.
+  static bool LoadTimersForProvider(const std::string& provider, bool conditional, const std::string& since,
+                                    const std::function<std::string(const std::string&, bool, bool&)>& httpGet,
                                     const std::function<bool(const std::string&, nlohmann::json&)>& parseJson,
-                                    std::vector<UltimateTimer>& outTimers);
+                                    ProviderTimers& out, LoadStats& stats);
+  // Decodes one "timers" entry (see TIMER_FIELDS), moving its strings out of
+  // timerJson. False if it has no "client_index".
+  static bool ParseTimer(nlohmann::json& timerJson, const std::string& provider, UltimateTimer& timer);
+
+  static void ReuseProviderTimers(const TimersData& held, const std::string& provider,
+                                  std::vector<UltimateTimer>& outTimers);
 
   static bool MapTimerToKodi(const UltimateTimer& timer, kodi::addon::PVRTimer& kodiTimer);
 
@@ -69,7 +122,10 @@ private:
 
   static PVR_TIMER_STATE MapTimerStateToKodi(int state);
 
-  std::vector<UltimateTimer> m_timers;
-  std::vector<UltimateTimerType> m_timerTypes;
-  mutable std::shared_mutex m_dataMutex;
+  AtomicSharedPtr<const TimerTypesData> m_timerTypes{std::make_shared<const TimerTypesData>()};
+  AtomicSharedPtr<const TimersData> m_timers{std::make_shared<const TimersData>()};
+  // Held by LoadTimers from reading the held snapshot to publishing, so the
+  // reload after AddTimer/UpdateTimer/DeleteTimer and a concurrent refresh
+  // cannot publish out of order (an older list and cursor last).
+  std::mutex m_loadMutex;
 };
\ No newline at end of file
@@ -11,10 +11,31 @@
     #define timegm _mkgmtime
 #endif
 
+const char* Utils::AcceptHeader(WireFormat preferred) {
+  switch (preferred) {
+    case WireFormat::CBOR: return "application/cbor, application/json;q=0.9";
+    case WireFormat::MSGPACK: return "application/msgpack, application/x-msgpack, application/json;q=0.9";
+    default: return "application/json";
+  }
+}
+
+Utils::WireFormat Utils::DetectWireFormat(unsigned char firstByte) {
+  // CBOR: 0xa0-0xbf map (0xbf indefinite length), 0xd9 the self-describe tag
+  // 55799 some encoders prefix. MessagePack: 0x80-0x8f fixmap, 0xde/0xdf
+  // map16/map32, and 0x90-0x9f/0xdc/0xdd arrays for completeness.
+  if ((firstByte >= 0xa0 && firstByte <= 0xbf) || firstByte == 0xd9) return WireFormat::CBOR;
+  if ((firstByte >= 0x80 && firstByte <= 0x9f) || (firstByte >= 0xdc && firstByte <= 0xdf)) return WireFormat::MSGPACK;
+  return WireFormat::JSON;
+}
+
 bool Utils::ParseJsonResponse(const std::string& response, nlohmann::json& document) {
   if (response.empty()) return false;
   try {
-    document = nlohmann::json::parse(response);
+    switch (DetectWireFormat(static_cast<unsigned char>(response.front()))) {
+      case WireFormat::CBOR: document = nlohmann::json::from_cbor(response); break;
+      case WireFormat::MSGPACK: document = nlohmann::json::from_msgpack(response); break;
+      default: document = nlohmann::json::parse(response); break;
+    }
     return true;
   } catch (const nlohmann::json::parse_error& e) {
     kodi::Log(ADDON_LOG_ERROR, "JSON parse error: %s (byte %zu)", e.what(), e.byte);
@@ -64,6 +85,24 @@ std::string Utils::UrlEncode(const std::string& value) {
   return escaped.str();
 }
 
+std::string Utils::UrlDecode(const std::string& value) {
+  std::string decoded;
+  decoded.reserve(value.size());
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (value[i] == '%' && i + 2 < value.size() &&
+        isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+        isxdigit(static_cast<unsigned char>(value[i + 2]))) {
+      decoded.push_back(static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16)));
+      i += 2;
+    } else if (value[i] == '+') {
+      decoded.push_back(' ');
+    } else {
+      decoded.push_back(value[i]);
+    }
+  }
+  return decoded;
+}
+
 std::string Utils::ConvertDrmJsonToLegacy(const nlohmann::json& drmJson) {
   if (!drmJson.is_object()) return "";
 
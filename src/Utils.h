@@ -5,9 +5,23 @@
 
 class Utils {
 public:
+    // Encodings a backend response may come in. The client asks for its
+    // preferred one (AcceptHeader); whichever the backend actually answers
+    // with is detected from the body itself, so a backend that ignores Accept
+    // keeps working with plain JSON.
+    enum class WireFormat { JSON, CBOR, MSGPACK };
+
+    static const char* AcceptHeader(WireFormat preferred);
+
+    // Every backend payload is an object, and the first byte of a CBOR map or
+    // a MessagePack map/array never starts JSON text.
+    static WireFormat DetectWireFormat(unsigned char firstByte);
+
+    // Parses a JSON, CBOR or MessagePack body (see DetectWireFormat).
     static bool ParseJsonResponse(const std::string& response, nlohmann::json& document);
     static std::string Base64Decode(const std::string& base64Data);
     static std::string UrlEncode(const std::string& value);
+    static std::string UrlDecode(const std::string& value);
     static std::string ConvertDrmJsonToLegacy(const nlohmann::json& drmJson);
     static time_t ParseISO8601(const std::string& isoString);
     static std::string ToISO8601(time_t time);
@@ -0,0 +1,84 @@
+#include "VfsHttpTransport.h"
+#include "Utils.h"
+#include <kodi/General.h>
+#include <kodi/Filesystem.h>
+#include <sstream>
+#include <memory>
+
+std::string VfsHttpTransport::FormatUrl(const HttpRequest& request) {
+  // Kodi parses everything after the first '|' as '&'-separated options:
+  // known names (customrequest, postdata, ...) configure curl, anything else
+  // is sent as a request header.
+  std::string formattedUrl = request.url;
+  char separator = '|';
+  auto appendOption = [&formattedUrl, &separator](const std::string& name, const std::string& value) {
+    formattedUrl += separator;
+    formattedUrl += name;
+    formattedUrl += "=";
+    formattedUrl += value;
+    separator = '&';
+  };
+
+  for (const auto& header : request.headers) {
+    appendOption(header.first, Utils::UrlEncode(header.second));
+  }
+  if (request.method != "GET") {
+    appendOption("customrequest", request.method);
+  }
+  if (!request.body.empty()) {
+    appendOption("postdata", Utils::UrlEncode(request.body));
+  }
+  return formattedUrl;
+}
+
+int VfsHttpTransport::ParseStatusLine(const std::string& protocolLine) {
+  // "HTTP/1.1 200 OK" - Kodi only exposes the raw status line.
+  std::istringstream ss(protocolLine);
+  std::string version;
+  int status = 0;
+  ss >> version >> status;
+  return ss.fail() ? 0 : status;
+}
+
+namespace {
+
+class VfsBodyReader : public HttpBodyReader {
+public:
+  explicit VfsBodyReader(std::unique_ptr<kodi::vfs::CFile> file) : m_file(std::move(file)) {}
+  ~VfsBodyReader() override { m_file->Close(); }
+
+  long Read(char* buffer, size_t size) override {
+    return static_cast<long>(m_file->Read(buffer, size));
+  }
+
+private:
+  std::unique_ptr<kodi::vfs::CFile> m_file;
+};
+
+}  // namespace
+
+std::unique_ptr<HttpBodyReader> VfsHttpTransport::Open(const HttpRequest& request, HttpResponse& response) {
+  auto file = std::make_unique<kodi::vfs::CFile>();
+  if (!file->OpenFile(FormatUrl(request), ADDON_READ_NO_CACHE)) {
+    return nullptr;
+  }
+
+  // OpenFile already fails on 4xx/5xx; a missing/unparseable status line on
+  // a successful open is treated as 200, which is what callers assumed
+  // before the status was exposed at all.
+  response.status = ParseStatusLine(file->GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_PROTOCOL, ""));
+  if (response.status == 0) response.status = 200;
+
+  // CFile cannot enumerate response headers, only look them up by name, so
+  // only the ones some caller (or InflatingHttpTransport) reads are copied over.
+  for (const char* name : {"etag", "last-modified", "content-encoding"}) {
+    std::string value = file->GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_HEADER, name);
+    if (!value.empty()) response.headers[name] = value;
+  }
+
+  if (response.status < 200 || response.status >= 300) {
+    file->Close();
+    return nullptr;
+  }
+  return std::make_unique<VfsBodyReader>(std::move(file));
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "HttpTransport.h"
+
+// Kodi VFS (libcurl inside Kodi) transport - the original request path. Opens
+// a fresh kodi::vfs::CFile per request, with headers and method passed as
+// "|"-appended protocol options. Handles https, redirects and proxies, so it
+// also serves as the fallback for PooledHttpTransport.
+class VfsHttpTransport : public HttpTransport {
+public:
+  VfsHttpTransport() = default;
+
+  std::unique_ptr<HttpBodyReader> Open(const HttpRequest& request, HttpResponse& response) override;
+  const char* Name() const override { return "vfs"; }
+
+private:
+  static std::string FormatUrl(const HttpRequest& request);
+  static int ParseStatusLine(const std::string& protocolLine);
+};